@@ -1,8 +1,18 @@
 #include "ResourceProfiler.h"
 
+#ifdef RUSAGE_THREAD
+static constexpr int usage_scope = RUSAGE_THREAD;   // cells run side by side; RUSAGE_SELF would bill them all
+#else
+static constexpr int usage_scope = RUSAGE_SELF;
+#endif
+
+static double cpu_seconds(const struct rusage& u) {
+    return u.ru_utime.tv_sec + u.ru_utime.tv_usec / 1e6 + u.ru_stime.tv_sec + u.ru_stime.tv_usec / 1e6;
+}
+
 ResourceProfiler::ResourceProfiler(fs::path p) : track_path(p) {
     start_wall = std::chrono::steady_clock::now();
-    getrusage(RUSAGE_SELF, &start_usage);
+    getrusage(usage_scope, &start_usage);
     std::error_code ec;
     if (!track_path.empty() && fs::exists(track_path, ec)) {
         start_disk = static_cast<intmax_t>(get_dir_size(track_path));
@@ -10,21 +20,35 @@ ResourceProfiler::ResourceProfiler(fs::path p) : track_path(p) {
     } else {
         start_disk = 0;
     }
+    account.cgroup = create_cell_cgroup();
+    outer = t_proc_account; t_proc_account = &account;
+}
+
+ResourceProfiler::~ResourceProfiler() {
+    if (t_proc_account == &account) t_proc_account = outer;
+    if (!account.cgroup.empty()) remove_cell_cgroup(account.cgroup);
 }
 
 ResourceUsage ResourceProfiler::stop() {
     auto end_wall = std::chrono::steady_clock::now();
     struct rusage end_usage;
-    getrusage(RUSAGE_SELF, &end_usage);
+    getrusage(usage_scope, &end_usage);
+    if (t_proc_account == &account) t_proc_account = outer;
     intmax_t end_disk = 0;
     std::error_code ec;
     if (active && !track_path.empty() && fs::exists(track_path, ec)) {
          end_disk = static_cast<intmax_t>(get_dir_size(track_path));
     }
-    double user_time = (end_usage.ru_utime.tv_sec - start_usage.ru_utime.tv_sec) +
-                       (end_usage.ru_utime.tv_usec - start_usage.ru_utime.tv_usec) / 1e6;
-    double sys_time = (end_usage.ru_stime.tv_sec - start_usage.ru_stime.tv_sec) +
-                      (end_usage.ru_stime.tv_usec - start_usage.ru_stime.tv_usec) / 1e6;
     std::chrono::duration<double> wall_diff = end_wall - start_wall;
-    return { user_time + sys_time, end_usage.ru_maxrss, wall_diff.count(), end_disk - start_disk };
+    ResourceUsage u = { cpu_seconds(end_usage) - cpu_seconds(start_usage), account.usage.peak_rss_kb, wall_diff.count(), end_disk - start_disk };
+    u.io_read_bytes = (uintmax_t)std::max(0L, end_usage.ru_inblock - start_usage.ru_inblock) * 512;
+    u.io_write_bytes = (uintmax_t)std::max(0L, end_usage.ru_oublock - start_usage.ru_oublock) * 512;
+    ResourceUsage children = { account.usage.cpu_seconds, account.usage.peak_rss_kb, 0, 0 };
+    children.io_read_bytes = account.usage.read_bytes; children.io_write_bytes = account.usage.write_bytes;
+    // The cgroup also sees grandchildren that were never waited for by us; its figures win where present.
+    if (!account.cgroup.empty()) read_cgroup_usage(account.cgroup, children);
+    u.cpu_time_seconds += children.cpu_time_seconds; u.peak_memory_kb = children.peak_memory_kb;
+    u.io_read_bytes += children.io_read_bytes; u.io_write_bytes += children.io_write_bytes;
+    u.cpu_pressure_seconds = children.cpu_pressure_seconds; u.memory_pressure_seconds = children.memory_pressure_seconds; u.io_pressure_seconds = children.io_pressure_seconds;
+    return u;
 }
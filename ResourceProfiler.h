@@ -1,16 +1,28 @@
 #pragma once
 #include "spip_utils.h"
+#include "spip_process.h"
 
+// Measures one unit of work on the calling thread: that thread's own CPU time plus everything
+// its children use. Children run in a dedicated cgroup v2 leaf when spip can create one under its
+// own cgroup (SPIP_NO_CGROUP opts out); otherwise their wait4 rusage is summed.
 class ResourceProfiler {
     std::chrono::time_point<std::chrono::steady_clock> start_wall;
     struct rusage start_usage;
     intmax_t start_disk;
     fs::path track_path;
     bool active = false;
+    ProcAccount account;
+    ProcAccount* outer = nullptr;
 
 public:
     ResourceProfiler(fs::path p = "");
+    ~ResourceProfiler();
+    ResourceProfiler(const ResourceProfiler&) = delete;
+    ResourceProfiler& operator=(const ResourceProfiler&) = delete;
     ResourceUsage stop();
 };
 
 uintmax_t get_dir_size(const fs::path& p);
+fs::path create_cell_cgroup();
+void read_cgroup_usage(const fs::path& cg, ResourceUsage& u);
+void remove_cell_cgroup(const fs::path& cg);
@@ -0,0 +1,72 @@
+#include "ResourceProfiler.h"
+
+// Cell cgroups live in <spip's own cgroup>/spip-<pid>/cell-<n>. cpu.stat and the *.pressure files
+// exist in every cgroup v2 directory; memory.peak and io.stat only when spip's own cgroup already
+// delegates those controllers. Missing files simply leave the wait4 figures in place.
+
+static fs::path cgroup_parent() {
+    static std::once_flag once; static fs::path parent;
+    std::call_once(once, [] {
+        if (std::getenv("SPIP_NO_CGROUP")) return;
+        std::string line, mount, own;
+        { std::ifstream mi("/proc/self/mountinfo"); while (std::getline(mi, line)) {
+            size_t dash = line.find(" - cgroup2 "); if (dash == std::string::npos) continue;
+            std::istringstream ss(line.substr(0, dash)); std::string f; for (int i = 0; i < 5 && ss >> f; ++i) mount = f;
+            break;
+        } }
+        { std::ifstream cg("/proc/self/cgroup"); while (std::getline(cg, line)) if (line.starts_with("0::")) own = line.substr(3); }
+        if (mount.empty() || own.empty()) return;
+        fs::path base = fs::path(mount) / fs::path(own).relative_path(); fs::path dir = base / ("spip-" + std::to_string(getpid()));
+        std::error_code ec; if (!fs::create_directory(dir, ec) || ec) return;
+        // Only what our own cgroup already hands down; spip never reconfigures cgroups outside its subtree.
+        std::string avail; { std::ifstream ifs(dir / "cgroup.controllers"); std::getline(ifs, avail); }
+        std::string want; for (const auto& c : split(avail, ' ')) if (c == "memory" || c == "io") want += "+" + c + " ";
+        if (!want.empty()) std::ofstream(dir / "cgroup.subtree_control") << want << std::flush;
+        parent = dir;
+        std::atexit([] { std::error_code e; fs::remove(parent, e); });
+    });
+    return parent;
+}
+
+fs::path create_cell_cgroup() {
+    static std::atomic<int> next{0};
+    fs::path parent = cgroup_parent(); if (parent.empty()) return {};
+    fs::path cell = parent / ("cell-" + std::to_string(next++)); std::error_code ec;
+    return fs::create_directory(cell, ec) && !ec ? cell : fs::path();
+}
+
+static std::map<std::string, uintmax_t> read_keyed(const fs::path& p) {
+    std::map<std::string, uintmax_t> kv; std::ifstream ifs(p); std::string k; uintmax_t v;
+    while (ifs >> k >> v) kv[k] = v;
+    return kv;
+}
+
+static double pressure_some_seconds(const fs::path& p) {
+    std::ifstream ifs(p); std::string line;
+    while (std::getline(ifs, line)) if (line.starts_with("some ")) {
+        size_t t = line.find("total="); if (t != std::string::npos) return std::strtoull(line.c_str() + t + 6, nullptr, 10) / 1e6;
+    }
+    return 0;
+}
+
+void read_cgroup_usage(const fs::path& cg, ResourceUsage& u) {
+    auto cpu = read_keyed(cg / "cpu.stat"); if (cpu.count("usage_usec")) u.cpu_time_seconds = cpu["usage_usec"] / 1e6;
+    std::ifstream peak(cg / "memory.peak"); uintmax_t bytes = 0; if (peak >> bytes) u.peak_memory_kb = (long)(bytes / 1024);
+    std::ifstream io(cg / "io.stat"); std::string line; bool have_io = false; uintmax_t rb = 0, wb = 0;
+    while (std::getline(io, line)) for (const auto& f : split(line, ' ')) {
+        if (f.starts_with("rbytes=")) { rb += std::strtoull(f.c_str() + 7, nullptr, 10); have_io = true; }
+        else if (f.starts_with("wbytes=")) { wb += std::strtoull(f.c_str() + 7, nullptr, 10); have_io = true; }
+    }
+    if (have_io) { u.io_read_bytes = rb; u.io_write_bytes = wb; }
+    u.cpu_pressure_seconds = pressure_some_seconds(cg / "cpu.pressure");
+    u.memory_pressure_seconds = pressure_some_seconds(cg / "memory.pressure");
+    u.io_pressure_seconds = pressure_some_seconds(cg / "io.pressure");
+}
+
+void remove_cell_cgroup(const fs::path& cg) {
+    if (rmdir(cg.c_str()) == 0 || errno == ENOENT) return;
+    // Stragglers (git's detached auto-gc, a server a test left running) go back where spip runs.
+    std::ifstream procs(cg / "cgroup.procs"); pid_t pid;
+    while (procs >> pid) join_cgroup(cg.parent_path().parent_path(), pid);
+    rmdir(cg.c_str());
+}
@@ -18,6 +18,7 @@ public:
     void start();
     void stop();
     void log_test_run_status(const std::string& status, const std::string& error_msg);
+    void log_env_tiers();
 private:
     void loop();
     void sample();
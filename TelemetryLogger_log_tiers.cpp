@@ -0,0 +1,30 @@
+#include "TelemetryLogger.h"
+#include "spip_env_tier.h"
+
+// Env placement decisions (place/spill/hit per env) and the run's RAM-tier hit rate.
+void TelemetryLogger::log_env_tiers() {
+    if (!db) return;
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS env_tier_events (test_id TEXT, timestamp REAL, env TEXT, tier TEXT, event TEXT, bytes INTEGER);"
+                     "CREATE TABLE IF NOT EXISTS env_tier_stats (test_id TEXT PRIMARY KEY, ram_hits INTEGER, disk_hits INTEGER, ram_placements INTEGER, "
+                     "disk_placements INTEGER, spills INTEGER, spilled_bytes INTEGER, ram_hit_rate REAL);", nullptr, nullptr, nullptr);
+    sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "INSERT INTO env_tier_events VALUES (?, ?, ?, ?, ?, ?);", -1, &stmt, nullptr) == SQLITE_OK) {
+        for (const auto& e : take_tier_events()) {
+            sqlite3_reset(stmt);
+            sqlite3_bind_text(stmt, 1, test_id.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_double(stmt, 2, e.at);
+            sqlite3_bind_text(stmt, 3, e.env.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 4, e.tier.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 5, e.event.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int64(stmt, 6, e.bytes);
+            sqlite3_step(stmt);
+        }
+        sqlite3_finalize(stmt);
+    }
+    TierStats s = tier_stats(); long hits = s.ram_hits + s.disk_hits;
+    if (sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO env_tier_stats VALUES (?, ?, ?, ?, ?, ?, ?, ?);", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, test_id.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int64(stmt, 2, s.ram_hits); sqlite3_bind_int64(stmt, 3, s.disk_hits);
+        sqlite3_bind_int64(stmt, 4, s.ram_placements); sqlite3_bind_int64(stmt, 5, s.disk_placements); sqlite3_bind_int64(stmt, 6, s.spills);
+        sqlite3_bind_int64(stmt, 7, s.spilled_bytes); sqlite3_bind_double(stmt, 8, hits ? (double)s.ram_hits / hits : 1.0);
+        sqlite3_step(stmt); sqlite3_finalize(stmt);
+    }
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+}
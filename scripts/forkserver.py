@@ -0,0 +1,217 @@
+import os, sys, time, socket, select, signal, site, importlib, runpy, traceback
+
+# Long-lived interpreter for one env: imports are paid once here, and every request runs in a
+# fresh fork. Usage: forkserver.py <socket> [preload,modules] [idle_seconds]
+#
+# Request: NUL-terminated fields, each tagged by its first byte (c=cwd, r=start from an empty
+# environment rather than the server's, e=NAME=value, a=argv entry, m=merge stderr into stdout,
+# g=cgroup directory to run in), ended by an empty field. Argv
+# is what would follow `python` on a command line: `-m mod args...`, `-c code args...` or
+# `script args...`. Response: "p <pid>\n" (the request's process group, so the caller can signal
+# it directly), frames "o <n>\n<bytes>" (stdout), "e <n>\n<bytes>" (stderr), then
+# "x <wait status> <utime us> <stime us> <maxrss kb> <inblock> <oublock>\n".
+# Closing the connection early sends SIGINT to the request's process group.
+
+
+def read_request(conn):
+    buf = b""
+    while not buf.endswith(b"\0\0"):
+        chunk = conn.recv(65536)
+        if not chunk:
+            return None
+        buf += chunk
+    req = {"cwd": None, "replace_env": False, "env": [], "argv": [], "merge": False, "cgroup": None}
+    for field in buf[:-2].split(b"\0"):
+        tag, val = field[:1], os.fsdecode(field[1:])
+        if tag == b"c":
+            req["cwd"] = val
+        elif tag == b"r":
+            req["replace_env"] = True
+        elif tag == b"e":
+            req["env"].append(val)
+        elif tag == b"a":
+            req["argv"].append(val)
+        elif tag == b"m":
+            req["merge"] = True
+        elif tag == b"g":
+            req["cgroup"] = val
+    return req
+
+
+def run(req):
+    # Runs in the forked child; never returns.
+    code = 0
+    try:
+        if req["cwd"]:
+            os.chdir(req["cwd"])
+        if req["replace_env"]:
+            os.environ.clear()
+        for kv in req["env"]:
+            k, _, v = kv.partition("=")
+            os.environ[k] = v
+        # Packages installed since the server started: drop stale finder caches, pick up new .pth files.
+        importlib.invalidate_caches()
+        for d in site.getsitepackages() if hasattr(site, "getsitepackages") else []:
+            site.addsitedir(d)
+        argv = req["argv"]
+        if argv and argv[0] == "-m":
+            sys.argv = [argv[1]] + argv[2:]
+            runpy.run_module(argv[1], run_name="__main__", alter_sys=True)
+        elif argv and argv[0] == "-c":
+            sys.argv = ["-c"] + argv[2:]
+            sys.path.insert(0, "")
+            exec(compile(argv[1], "<string>", "exec"), {"__name__": "__main__", "__builtins__": __builtins__})
+        elif argv:
+            sys.argv = list(argv)
+            sys.path.insert(0, os.path.dirname(os.path.abspath(argv[0])))
+            runpy.run_path(argv[0], run_name="__main__")
+    except SystemExit as e:
+        code = e.code if isinstance(e.code, int) else (0 if e.code is None else 1)
+        if not isinstance(e.code, int) and e.code is not None:
+            sys.stderr.write(str(e.code) + "\n")
+    except KeyboardInterrupt:
+        signal.signal(signal.SIGINT, signal.SIG_DFL)
+        os.kill(os.getpid(), signal.SIGINT)
+    except BaseException:
+        etype, e, tb = sys.exc_info()
+        traceback.print_exception(etype, e, tb.tb_next)   # start at the user's code, not run()
+        code = 1
+    try:
+        sys.stdout.flush()
+        sys.stderr.flush()
+    except Exception:
+        pass
+    os._exit(code & 0xFF)
+
+
+def handle(conn):
+    req = read_request(conn)
+    if req is None or not req["argv"]:
+        return
+    out_r, out_w = os.pipe()
+    err_r, err_w = os.pipe()
+    pid = os.fork()
+    if pid == 0:
+        conn.close()
+        os.setpgid(0, 0)
+        if req["cgroup"]:
+            try:
+                with open(os.path.join(req["cgroup"], "cgroup.procs"), "w") as f:
+                    f.write(str(os.getpid()))
+            except OSError:
+                pass
+        signal.signal(signal.SIGINT, signal.default_int_handler)
+        signal.signal(signal.SIGPIPE, signal.SIG_DFL)
+        os.close(out_r)
+        os.close(err_r)
+        null = os.open(os.devnull, os.O_RDONLY)
+        os.dup2(null, 0)
+        os.dup2(out_w, 1)
+        os.dup2(out_w if req["merge"] else err_w, 2)
+        sys.stdin = open(0, "r", closefd=False)
+        run(req)
+    os.close(out_w)
+    os.close(err_w)
+    conn.sendall(b"p " + str(pid).encode() + b"\n")
+    pipes = {out_r: b"o", err_r: b"e"}
+    while pipes:
+        ready, _, _ = select.select(list(pipes) + [conn], [], [])
+        if conn in ready and not conn.recv(1, socket.MSG_PEEK):
+            try:
+                os.killpg(pid, signal.SIGINT)
+            except OSError:
+                pass
+            return
+        for fd in ready:
+            if fd is conn:
+                continue
+            data = os.read(fd, 65536)
+            if not data:
+                os.close(fd)
+                del pipes[fd]
+                continue
+            conn.sendall(pipes[fd] + b" " + str(len(data)).encode() + b"\n" + data)
+    _, status, ru = os.wait4(pid, 0)
+    usage = (status, int(ru.ru_utime * 1e6), int(ru.ru_stime * 1e6), ru.ru_maxrss, ru.ru_inblock, ru.ru_oublock)
+    conn.sendall(b"x " + " ".join(str(v) for v in usage).encode() + b"\n")
+
+
+def site_state():
+    # Any install, uninstall or pool reset renames entries in site-packages, which moves its mtime.
+    state = []
+    for d in site.getsitepackages() if hasattr(site, "getsitepackages") else []:
+        try:
+            st = os.stat(d)
+            state.append((st.st_ino, st.st_mtime_ns))
+        except OSError:
+            state.append(None)
+    return state
+
+
+def serve(path, idle):
+    signal.signal(signal.SIGCHLD, signal.SIG_IGN)   # finished handlers reap themselves
+    venv_cfg = os.path.join(sys.prefix, "pyvenv.cfg")
+    last = time.monotonic()
+    while True:
+        ready, _, _ = select.select([srv], [], [], min(idle, 10))
+        if ready:
+            last = time.monotonic()
+        # Idle, or the env was removed or rebuilt under us, or the packages behind the preloaded
+        # modules changed: step aside; the caller falls back to a fresh interpreter and the next one
+        # starts a new server.
+        stale = bool(preload) and site_state() != site_at_start
+        if stale or time.monotonic() - last >= idle or not os.path.exists(venv_cfg) or os.stat(venv_cfg).st_ino != venv_ino:
+            try:
+                if os.stat(path).st_ino == sock_ino:
+                    os.unlink(path)
+            except OSError:
+                pass
+            os._exit(0)
+        if not ready:
+            continue
+        conn, _ = srv.accept()
+        if os.fork() == 0:
+            srv.close()
+            signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+            try:
+                handle(conn)
+            except Exception:
+                pass
+            os._exit(0)
+        conn.close()
+
+
+if __name__ == "__main__":
+    path = sys.argv[1]
+    if sys.path and sys.path[0] == os.path.dirname(os.path.abspath(__file__)):
+        sys.path.pop(0)   # requests get their own sys.path[0], as a fresh interpreter would
+    preload = [m for m in (sys.argv[2] if len(sys.argv) > 2 else "").split(",") if m]
+    idle = float(sys.argv[3]) if len(sys.argv) > 3 else 300
+    srv = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        srv.bind(path)
+    except OSError:
+        probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            probe.connect(path)
+            sys.exit(0)   # someone else is already serving this env
+        except OSError:
+            os.unlink(path)
+            srv.bind(path)
+    srv.listen(64)
+    sock_ino = os.stat(path).st_ino
+    venv_ino = os.stat(os.path.join(sys.prefix, "pyvenv.cfg")).st_ino
+    site_at_start = site_state()
+    for mod in preload:
+        try:
+            importlib.import_module(mod)
+        except Exception:
+            pass
+    # Detach only once the socket is listening, so the launcher can connect as soon as we return.
+    if os.fork() != 0:
+        os._exit(0)
+    os.setsid()
+    null = os.open(os.devnull, os.O_RDWR)
+    for fd in (0, 1, 2):
+        os.dup2(null, fd)
+    serve(path, idle)
@@ -20,6 +20,10 @@ def safe_extract(zip_path, extract_to):
                 if os.path.isabs(member.filename) or ".." in member.filename:
                     print(f"Skipping dangerous member: {member.filename}")
                     continue
+                # Envs may share files with the base snapshot via hardlinks; replace, never write through.
+                target = os.path.join(extract_to, member.filename)
+                if not member.is_dir() and (os.path.islink(target) or os.path.isfile(target)):
+                    os.unlink(target)
                 z.extract(member, extract_to)
     except Exception as e:
         print(f"Error extracting {zip_path}: {e}")
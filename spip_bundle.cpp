@@ -1,5 +1,6 @@
 #include "spip_bundle.h"
 #include "spip_env.h"
+#include "spip_process.h"
 
 void generate_setup_py(const fs::path& target_dir, const std::string& pkg_name);
 
@@ -14,11 +15,13 @@ void bundle_package(const Config& cfg, const std::string& path) {
     if (!fs::exists(target_dir / "setup.py")) generate_setup_py(target_dir, pkg_name);
     setup_project_env(const_cast<Config&>(cfg));
     fs::path python_bin = cfg.project_env_path / "bin" / "python";
-    if (run_shell(std::format("{} -m pip --version >/dev/null 2>&1", quote_arg(python_bin.string())).c_str()) != 0) {
-        run_shell(std::format("{} -m ensurepip --upgrade", quote_arg(python_bin.string())).c_str());
+    ProcOptions q; q.silent = true; q.quiet = true;
+    if (run_process({python_bin.string(), "-m", "pip", "--version"}, q) != 0) {
+        run_process({python_bin.string(), "-m", "ensurepip", "--upgrade"});
     }
     std::cout << BLUE << "🚀 Installing package..." << RESET << std::endl;
-    if (run_shell(std::format("cd {} && {} -m pip install .", quote_arg(target_dir.string()), quote_arg(python_bin.string())).c_str()) == 0) {
+    ProcOptions at_pkg; at_pkg.cwd = target_dir;
+    if (run_process({python_bin.string(), "-m", "pip", "install", "."}, at_pkg) == 0) {
         std::cout << GREEN << "✔️  Package installed successfully." << RESET << std::endl;
     }
 }
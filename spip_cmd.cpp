@@ -6,6 +6,8 @@
 #include "spip_distributed.h"
 #include "spip_db.h"
 #include "spip_bundle.h"
+#include "spip_serve.h"
+#include "spip_process.h"
 
 void run_command(Config& cfg, const std::vector<std::string>& args) {
     if (args.empty()) { std::cout << "Usage: spip <cmd> [args...]\n" << std::endl; return; }
@@ -17,14 +19,28 @@ void run_command(Config& cfg, const std::vector<std::string>& args) {
         }
         cmd_diff(argv_vec.size(), argv_vec.data());
     } else if (cmd == "bundle") { if (require_args(args, 2, "Usage: spip bundle <folder>")) bundle_package(cfg, args[1]); }
+    else if (cmd == "serve") {
+        std::string bind_addr = "0.0.0.0"; int port = 8080;
+        for (size_t i = 1; i + 1 < args.size(); ++i) { if (args[i] == "--port") port = std::stoi(args[++i]); else if (args[i] == "--bind") bind_addr = args[++i]; }
+        serve_mirror(cfg, bind_addr, port);
+    }
     else if (cmd == "boot") { if (require_args(args, 2, "Usage: spip boot <script.py>")) { setup_project_env(cfg); boot_environment(cfg, args[1]); } }
     else if (cmd == "fetch-db") {
-        init_db(); std::ifstream f("all_packages.txt"); if (!f.is_open()) return;
-        std::queue<std::string> q; std::string l; while (std::getline(f, l)) if (!l.empty()) q.push(l);
-        std::mutex m; std::atomic<int> c{0}; std::vector<std::thread> ts;
-        for (int i = 0; i < 16; ++i) ts.emplace_back(db_worker, std::ref(q), std::ref(m), std::ref(c), q.size(), cfg);
-        for (auto& t : ts) t.join();
-        run_shell(std::format("cd {} && git add packages && git commit -m \"Update DB\"", quote_arg(cfg.repo_path.parent_path().string() + "/db")).c_str());
+        if (cfg.offline) { std::cout << YELLOW << "⚠️ fetch-db is unavailable in offline mode." << RESET << std::endl; return; }
+        init_db();
+        if (args.size() > 1 && args[1] == "--closure") {
+            auto roots = collect_closure_roots(cfg, args.size() > 2 ? args[2] : "");
+            if (roots.empty()) { std::cout << YELLOW << "⚠️ No closure roots found (requirements file or .spip_manual)." << RESET << std::endl; return; }
+            sync_closure(cfg, roots);
+        } else {
+            std::ifstream f("all_packages.txt"); if (!f.is_open()) return;
+            std::queue<std::string> q; std::string l; while (std::getline(f, l)) if (!l.empty()) q.push(l);
+            std::mutex m; std::atomic<int> c{0}; std::vector<std::thread> ts;
+            for (int i = 0; i < 16; ++i) ts.emplace_back(db_worker, std::ref(q), std::ref(m), std::ref(c), q.size(), cfg);
+            for (auto& t : ts) t.join();
+        }
+        ProcOptions opt; opt.cwd = cfg.spip_root / "db";
+        if (run_process({"git", "add", "packages"}, opt) == 0) run_process({"git", "commit", "-m", "Update DB"}, opt);
     } else if (cmd == "top") run_command_top(cfg, args);
     else if (cmd == "install" || cmd == "i") run_command_install(cfg, args);
     else if (cmd == "uninstall" || cmd == "remove") run_command_uninstall(cfg, args);
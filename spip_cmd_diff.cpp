@@ -2,6 +2,7 @@
 #include "spip_diff.h"
 #include "spip_delta_db.h"
 #include "spip_utils.h"
+#include "spip_process.h"
 #include <iostream>
 #include <cstdlib>
 #include <regex>
@@ -13,9 +14,10 @@ namespace fs = std::filesystem;
 static std::string fetch_wheel_url(const std::string& package, const std::string& version) {
     std::string json_file = "/tmp/pypi_" + package + "_" + version + ".json";
     std::string url = "https://pypi.org/pypi/" + package + "/" + version + "/json";
-    std::string cmd = "curl -sSL " + quote_arg(url) + " > " + quote_arg(json_file);
+    ProcOptions opt;
+    opt.stdout_path = json_file;
     
-    if (system(cmd.c_str()) != 0) return "";
+    if (run_process({"curl", "-sSL", url}, opt) != 0) return "";
     
     // Read JSON
     std::ifstream f(json_file);
@@ -90,8 +92,7 @@ int cmd_diff(int argc, char** argv) {
         std::string filename = wheel_url.substr(wheel_url.rfind('/') + 1);
         std::string local_path = "/tmp/" + filename;
         
-        std::string cmd = "curl -sSL -o " + quote_arg(local_path) + " " + quote_arg(wheel_url);
-        if (system(cmd.c_str()) == 0) {
+        if (run_process({"curl", "-sSL", "-o", local_path, wheel_url}) == 0) {
             v.wheel_path = local_path;
             
             // Get file size
@@ -150,11 +151,10 @@ int cmd_diff(int argc, char** argv) {
                 std::string perm_delta = delta_cache + "/" + delta_filename;
                 
                 // Re-create delta in permanent location
-                std::string cmd = "xdelta3 -e -s " + quote_arg(versions[i].wheel_path) + " " +
-                                 quote_arg(versions[j].wheel_path) + " " + 
-                                 quote_arg(perm_delta) + " 2>/dev/null";
+                ProcOptions quiet;
+                quiet.quiet = true;
                 
-                if (system(cmd.c_str()) == 0) {
+                if (run_process({"xdelta3", "-e", "-s", versions[i].wheel_path, versions[j].wheel_path, perm_delta}, quiet) == 0) {
                     DeltaRecord rec;
                     rec.package_name = package;
                     rec.source_version = versions[i].version;
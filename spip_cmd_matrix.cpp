@@ -3,13 +3,26 @@
 #include "spip_matrix.h"
 #include "spip_distributed.h"
 
+// "20m", "90s", "1h30m"; a bare number is seconds. Returns -1 when it does not parse.
+static double parse_duration(const std::string& s) {
+    double total = 0; size_t i = 0;
+    while (i < s.size()) {
+        size_t used = 0; double n; try { n = std::stod(s.substr(i), &used); } catch (...) { return -1; }
+        i += used; char unit = i < s.size() ? s[i++] : 's';
+        if (unit == 'h') total += n * 3600; else if (unit == 'm') total += n * 60; else if (unit == 's') total += n; else return -1;
+    }
+    return s.empty() ? -1 : total;
+}
+
 void run_command_matrix(Config& cfg, const std::vector<std::string>& args) {
     std::string cmd = args[0];
     if (cmd == "matrix") {
         ensure_dirs(cfg); if (args.size() < 2) return;
         std::string pkg = ""; std::string test_script = ""; std::string python_ver = "auto";
-        bool profile = false; bool telemetry = false; bool no_cleanup = false;
-        int revision_limit = -1; bool test_all_revisions = false; bool smoke_test = false;
+        bool profile = false; bool telemetry = false; bool no_cleanup = false; bool fresh = false; bool vary_python = false;
+        int revision_limit = -1; bool test_all_revisions = false; bool smoke_test = false; std::string bisect_range;
+        int strength = 0; int pkg_limit = 1; bool expand = false; std::vector<std::string> deps; std::string packages_file;
+        double deadline = 0, cell_timeout = -1, speculate = -1;
         for (size_t i = 1; i < args.size(); ++i) {
             std::string arg = args[i];
             if (arg == "--python" && i + 1 < args.size()) python_ver = args[++i];
@@ -17,14 +30,45 @@ void run_command_matrix(Config& cfg, const std::vector<std::string>& args) {
             else if (arg == "--telemetry") telemetry = true;
             else if (arg == "--smoke") smoke_test = true;
             else if (arg == "--no-cleanup") no_cleanup = true;
+            else if (arg == "--fresh") fresh = true;
             else if (arg == "--limit" && i + 1 < args.size()) revision_limit = std::stoi(args[++i]);
             else if (arg == "--all") test_all_revisions = true;
+            else if (arg == "--bisect" && i + 1 < args.size()) bisect_range = args[++i];
+            else if (arg == "--vary-python") vary_python = true;
+            else if (arg == "--pairwise") { vary_python = true; strength = 2; }
+            else if (arg == "--plan" && i + 1 < args.size()) { vary_python = true; strength = std::stoi(args[++i]); }
+            else if (arg == "--dep" && i + 1 < args.size()) deps.push_back(args[++i]);
+            else if (arg == "--pkg-limit" && i + 1 < args.size()) pkg_limit = std::stoi(args[++i]);
+            else if (arg == "--expand") expand = true;
+            else if (arg == "--packages" && i + 1 < args.size()) packages_file = args[++i];
+            else if (arg == "--cell-timeout" && i + 1 < args.size()) {
+                cell_timeout = parse_duration(args[++i]);
+                if (cell_timeout < 0) { std::cerr << RED << "❌ Bad --cell-timeout " << args[i] << " (e.g. 10m, 0 for none)" << RESET << "\n"; return; }
+            }
+            else if (arg == "--speculate" && i + 1 < args.size()) speculate = std::atof(args[++i].c_str());
+            else if (arg == "--deadline" && i + 1 < args.size()) {
+                deadline = parse_duration(args[++i]);
+                if (deadline <= 0) { std::cerr << RED << "❌ Bad --deadline " << args[i] << " (e.g. 20m, 90s, 1h30m)" << RESET << "\n"; return; }
+            }
             else if (arg.starts_with("--")) continue;
             else { if (pkg.empty()) pkg = arg; else if (test_script.empty()) test_script = arg; }
         }
-        if (pkg.empty()) return;
-        Config m_cfg = cfg; m_cfg.telemetry = telemetry;
+        std::vector<std::string> packages;   // --packages FILE (or - for stdin): names separated by whitespace, # comments
+        if (!packages_file.empty()) {
+            std::ifstream f(packages_file); std::istream& in = (packages_file == "-") ? std::cin : f; std::string line, name;
+            while (std::getline(in, line)) { std::istringstream ls(line.substr(0, line.find('#'))); while (ls >> name) packages.push_back(name); }
+            if (packages.empty()) { std::cerr << RED << "❌ No packages in " << packages_file << RESET << "\n"; return; }
+            if (test_script.empty()) test_script = pkg;   // no package argument in batch mode: the first positional is the test script
+        }
+        if (pkg.empty() && packages.empty()) return;
+        Config m_cfg = cfg; m_cfg.telemetry = telemetry; if (fresh) m_cfg.matrix_cache = false;
+        m_cfg.matrix_strength = strength; m_cfg.matrix_deps = deps; m_cfg.matrix_expand = expand;
+        if (cell_timeout >= 0) m_cfg.matrix_cell_timeout = cell_timeout;
+        if (speculate >= 0) m_cfg.matrix_speculate = speculate;
+        if (deadline > 0) m_cfg.matrix_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds((long long)(deadline * 1000));
         if (smoke_test) run_thread_test(m_cfg);
-        matrix_test(m_cfg, pkg, test_script, python_ver, profile, no_cleanup, revision_limit, test_all_revisions, false);
-    }
+        if (!packages.empty()) { matrix_batch(m_cfg, packages, test_script, python_ver, profile, no_cleanup, revision_limit, test_all_revisions); return; }
+        matrix_test(m_cfg, pkg, test_script, python_ver, profile, no_cleanup, revision_limit, test_all_revisions, vary_python, pkg_limit, "", bisect_range);
+    } else if (cmd == "master") { if (require_args(args, 2, "Usage: spip master <pkg> [--limit N] [--plan T|--pairwise]")) run_master(cfg, args); }
+    else if (cmd == "worker") run_worker(cfg);
 }
@@ -1,11 +1,13 @@
 #include "spip_db.h"
+#include "spip_process.h"
 
 void init_db() {
     const char* home = std::getenv("HOME");
     fs::path db_path = fs::path(home) / ".spip" / "db";
     if (!fs::exists(db_path)) {
         fs::create_directories(db_path);
-        run_shell(std::format("cd \"{}\" && git init && git commit --allow-empty -m \"Initial DB commit\"", db_path.string()).c_str());
+        ProcOptions opt; opt.cwd = db_path;
+        if (run_process({"git", "init"}, opt) == 0) run_process({"git", "commit", "--allow-empty", "-m", "Initial DB commit"}, opt);
     }
 }
 
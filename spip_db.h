@@ -8,3 +8,8 @@ void db_worker(std::queue<std::string>& q, std::mutex& m, std::atomic<int>& coun
 std::string extract_field(const std::string& json, const std::string& key);
 std::vector<std::string> extract_array(const std::string& json, const std::string& key);
 std::vector<std::string> get_all_versions(const std::string& pkg);
+bool is_known_missing(const std::string& key);
+void mark_missing(const std::string& key);
+void purge_missing(bool all = false);
+std::vector<std::string> collect_closure_roots(const Config& cfg, const std::string& req_file = "");
+void sync_closure(const Config& cfg, const std::vector<std::string>& roots);
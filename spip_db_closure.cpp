@@ -0,0 +1,44 @@
+#include "spip_db.h"
+#include "spip_install.h"
+
+std::vector<std::string> collect_closure_roots(const Config& cfg, const std::string& req_file) {
+    std::vector<std::string> roots; std::string line;
+    if (!req_file.empty()) {
+        std::ifstream ifs(req_file); std::regex name_re(R"(^\s*([A-Za-z0-9][A-Za-z0-9_.-]*))"); std::smatch m;
+        while (std::getline(ifs, line)) {
+            if (line.find('#') != std::string::npos) line = line.substr(0, line.find('#'));
+            if (line.starts_with("-") || !std::regex_search(line, m, name_re)) continue;
+            roots.push_back(m[1].str());
+        }
+        return roots;
+    }
+    if (!fs::exists(cfg.envs_root)) return roots;
+    std::set<std::string> uniq;
+    for (const auto& entry : fs::directory_iterator(cfg.envs_root)) {
+        fs::path mf = entry.path() / ".spip_manual"; if (!fs::exists(mf)) continue;
+        std::ifstream ifs(mf); while (std::getline(ifs, line)) if (!line.empty() && uniq.insert(line).second) roots.push_back(line);
+    }
+    return roots;
+}
+
+void sync_closure(const Config& cfg, const std::vector<std::string>& roots) {
+    auto norm = [](std::string n) { std::transform(n.begin(), n.end(), n.begin(), ::tolower); std::replace(n.begin(), n.end(), '_', '-'); std::replace(n.begin(), n.end(), '.', '-'); return n; };
+    std::set<std::string> seen; std::vector<std::string> wave;
+    for (const auto& r : roots) if (seen.insert(norm(r)).second) wave.push_back(r);
+    int round = 0; size_t total = 0;
+    while (!wave.empty() && !g_interrupted) {
+        std::cout << CYAN << "🌊 Wave " << ++round << ": " << wave.size() << " packages" << RESET << std::endl;
+        std::queue<std::string> q; for (const auto& p : wave) q.push(p);
+        std::mutex m; std::atomic<int> c{0}; std::vector<std::thread> ts;
+        int n = std::min<int>(wave.size(), std::max(16, cfg.concurrency));
+        for (int i = 0; i < n; ++i) ts.emplace_back(db_worker, std::ref(q), std::ref(m), std::ref(c), wave.size(), cfg);
+        for (auto& t : ts) t.join();
+        total += wave.size(); std::vector<std::string> next;
+        for (const auto& p : wave) {
+            if (!fs::exists(get_db_path(p))) continue;
+            for (const auto& d : get_package_info(p).dependencies) if (seen.insert(norm(d)).second) next.push_back(d);
+        }
+        wave = next;
+    }
+    std::cout << GREEN << "✨ Closure synced: " << total << " packages in " << round << " waves." << RESET << std::endl;
+}
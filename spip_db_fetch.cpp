@@ -1,13 +1,24 @@
 #include "spip_db.h"
+#include "spip_process.h"
 
 void fetch_package_metadata(const Config& cfg, const std::string& pkg) {
     fs::path target = get_db_path(pkg); if (fs::exists(target) && fs::file_size(target) > 0) return;
-    static std::mutex m_fetch; std::lock_guard<std::mutex> lock(m_fetch);
-    if (fs::exists(target) && fs::file_size(target) > 0) return;
+    std::string neg_key = "pkg:" + target.stem().string();
+    if (cfg.offline || is_known_missing(neg_key)) return;
+    static std::mutex m_reg; static std::map<std::string, std::shared_ptr<std::mutex>> locks;
+    std::shared_ptr<std::mutex> pkg_lock; { std::lock_guard<std::mutex> l(m_reg); auto& sl = locks[target.string()]; if (!sl) sl = std::make_shared<std::mutex>(); pkg_lock = sl; }
+    std::lock_guard<std::mutex> lock(*pkg_lock);
+    if ((fs::exists(target) && fs::file_size(target) > 0) || is_known_missing(neg_key)) return;
     fs::create_directories(target.parent_path());
     std::string url = std::format("{}/pypi/{}/json", cfg.pypi_mirror, pkg);
     fs::path temp_target = target; temp_target += ".tmp";
-    if (run_shell(std::format("curl -s -L \"{}\" -o \"{}\"", url, temp_target.string()).c_str()) == 0 && fs::exists(temp_target)) fs::rename(temp_target, target);
+    ProcResult r = capture_process({"curl", "-f", "-s", "-L", "--connect-timeout", "5", "--max-time", "60", "-w", "%{http_code}", url, "-o", temp_target.string()});
+    if (r.status == 0 && fs::exists(temp_target)) fs::rename(temp_target, target);
+    else {
+        std::error_code ec; fs::remove(temp_target, ec);
+        // Only a definite "not there"; rate limits and 5xx are worth retrying on the next run.
+        if (r.out == "404" || r.out == "410") mark_missing(neg_key);
+    }
 }
 
 void db_worker(std::queue<std::string>& q, std::mutex& m, std::atomic<int>& count, int total, Config cfg) {
@@ -0,0 +1,61 @@
+#include "spip_db.h"
+
+// Persistent negative cache: names and wheel URLs that upstream answered with 404 are
+// remembered for SPIP_NEG_TTL seconds (default 24h) so repeated lookups fail without network.
+static std::mutex m_neg;
+static std::map<std::string, time_t> neg_entries;
+static bool neg_loaded = false;
+
+static time_t negative_ttl() {
+    const char* t = std::getenv("SPIP_NEG_TTL");
+    try { return t ? std::stol(t) : 86400; } catch (...) { return 86400; }
+}
+
+static sqlite3* open_negative_cache() {
+    fs::path p = fs::path(std::getenv("HOME")) / ".spip" / "negative_cache.db";
+    std::error_code ec; fs::create_directories(p.parent_path(), ec);
+    sqlite3* db; if (sqlite3_open(p.c_str(), &db) != SQLITE_OK) { sqlite3_close(db); return nullptr; }
+    sqlite3_busy_timeout(db, 10000);
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS missing (key TEXT PRIMARY KEY, marked_at INTEGER);", nullptr, nullptr, nullptr);
+    return db;
+}
+
+static void load_negative_cache() {
+    if (neg_loaded) return;
+    neg_loaded = true;
+    sqlite3* db = open_negative_cache(); if (!db) return;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT key, marked_at FROM missing WHERE marked_at > ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, std::time(nullptr) - negative_ttl());
+        while (sqlite3_step(stmt) == SQLITE_ROW) neg_entries[(const char*)sqlite3_column_text(stmt, 0)] = sqlite3_column_int64(stmt, 1);
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+}
+
+bool is_known_missing(const std::string& key) {
+    std::lock_guard<std::mutex> l(m_neg); load_negative_cache();
+    auto it = neg_entries.find(key); if (it == neg_entries.end()) return false;
+    if (std::time(nullptr) - it->second > negative_ttl()) { neg_entries.erase(it); return false; }
+    return true;
+}
+
+void mark_missing(const std::string& key) {
+    std::lock_guard<std::mutex> l(m_neg); load_negative_cache();
+    time_t now = std::time(nullptr); neg_entries[key] = now;
+    sqlite3* db = open_negative_cache(); if (!db) return;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO missing (key, marked_at) VALUES (?, ?);", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_int64(stmt, 2, now);
+        sqlite3_step(stmt); sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+}
+
+void purge_missing(bool all) {
+    std::lock_guard<std::mutex> l(m_neg); neg_entries.clear(); neg_loaded = false;
+    sqlite3* db = open_negative_cache(); if (!db) return;
+    std::string sql = all ? "DELETE FROM missing;" : std::format("DELETE FROM missing WHERE marked_at <= {};", std::time(nullptr) - negative_ttl());
+    sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+}
@@ -2,6 +2,7 @@
 #include "spip_db.h"
 #include "spip_utils.h"
 #include "spip_python.h"
+#include "spip_process.h"
 #include <iostream>
 #include <algorithm>
 #include <cstdio>
@@ -44,10 +45,10 @@ DiffResult compute_vcdiff(const std::string& path_a, const std::string& path_b)
     std::string delta_path = "/tmp/delta_" + std::to_string(getpid()) + ".vcdiff";
     
     // Run xdelta3 to create delta: xdelta3 -e -s source target delta
-    std::string cmd = "xdelta3 -e -s " + quote_arg(path_a) + " " + 
-                      quote_arg(path_b) + " " + quote_arg(delta_path) + " 2>/dev/null";
+    ProcOptions quiet;
+    quiet.quiet = true;
     
-    int ret = system(cmd.c_str());
+    int ret = run_process({"xdelta3", "-e", "-s", path_a, path_b, delta_path}, quiet);
     if (ret == 0) {
         // Get delta size
         FILE* f = fopen(delta_path.c_str(), "rb");
@@ -1,22 +1,38 @@
 #include "spip_distributed.h"
 #include "spip_db.h"
 #include "spip_env.h"
+#include "spip_matrix_plan.h"
+
+fs::path get_queue_db_path(const Config& cfg) {
+    const char* q = std::getenv("SPIP_QUEUE_DB");
+    return q ? fs::path(q) : cfg.spip_root / "queue.db";
+}
 
 void init_queue_db(const Config& cfg) {
-    sqlite3* db; sqlite3_open((cfg.spip_root / "queue.db").c_str(), &db); sqlite3_busy_timeout(db, 10000);
+    sqlite3* db; sqlite3_open(get_queue_db_path(cfg).c_str(), &db); sqlite3_busy_timeout(db, 10000);
     sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS work_queue (id INTEGER PRIMARY KEY, pkg_name TEXT, pkg_ver TEXT, py_ver TEXT, status TEXT, worker_id TEXT, result_json TEXT, started_at REAL, finished_at REAL);", nullptr, nullptr, nullptr);
+    sqlite3_exec(db, "ALTER TABLE work_queue ADD COLUMN spec_worker TEXT;", nullptr, nullptr, nullptr);   // fails harmlessly once it exists
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS wheel_peers (worker_id TEXT, peer_url TEXT, wheel TEXT, sha256 TEXT, size INTEGER, updated_at REAL, PRIMARY KEY (worker_id, wheel)); CREATE INDEX IF NOT EXISTS idx_wheel_peers_wheel ON wheel_peers(wheel);", nullptr, nullptr, nullptr);
     sqlite3_close(db);
 }
 
 void run_master(const Config& cfg, const std::vector<std::string>& args) {
-    if (args.size() < 2) return; std::string pkg = args[1]; int limit = -1;
-    for (size_t i = 2; i < args.size(); ++i) if (args[i] == "--limit" && i + 1 < args.size()) limit = std::stoi(args[++i]);
+    if (args.size() < 2) return; std::string pkg = args[1]; int limit = -1, strength = 0;
+    for (size_t i = 2; i < args.size(); ++i) {
+        if (args[i] == "--limit" && i + 1 < args.size()) limit = std::stoi(args[++i]);
+        else if (args[i] == "--plan" && i + 1 < args.size()) strength = std::stoi(args[++i]);
+        else if (args[i] == "--pairwise") strength = 2;
+    }
     setup_project_env(const_cast<Config&>(cfg)); init_queue_db(cfg);
     auto versions = get_all_versions(pkg); std::vector<std::string> py_v = {"3.7", "3.8", "3.9", "3.10", "3.11", "3.12", "3.13"};
-    sqlite3* db; sqlite3_open((cfg.spip_root / "queue.db").c_str(), &db); sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
-    int count = 0; for (const auto& v : versions) {
-        if (limit > 0 && count++ >= limit) break;
-        for (const auto& py : py_v) sqlite3_exec(db, std::format("INSERT INTO work_queue (pkg_name, pkg_ver, py_ver, status) VALUES ({}, {}, {}, 'PENDING');", quote_arg(pkg), quote_arg(v), quote_arg(py)).c_str(), nullptr, nullptr, nullptr);
-    }
+    sqlite3* db; sqlite3_open(get_queue_db_path(cfg).c_str(), &db); sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+    if (limit > 0 && versions.size() > (size_t)limit) versions.resize(limit);
+    // Every version x Python. A t-wise covering array of just these two dimensions, for any t >= 2,
+    // is that same product, so --plan only changes anything at t = 1.
+    if (strength >= 2) { std::cout << YELLOW << std::format("⚠️  --plan {} over version x Python covers every combination: queuing the full matrix", strength) << RESET << std::endl; strength = 0; }
+    std::vector<std::vector<std::string>> cells;
+    if (strength > 0) cells = covering_array({versions, py_v}, strength); else for (const auto& v : versions) for (const auto& py : py_v) cells.push_back({v, py});
+    for (const auto& c : cells) sqlite3_exec(db, std::format("INSERT INTO work_queue (pkg_name, pkg_ver, py_ver, status) VALUES ({}, {}, {}, 'PENDING');", quote_arg(pkg), quote_arg(c[0]), quote_arg(c[1])).c_str(), nullptr, nullptr, nullptr);
+    std::cout << CYAN << std::format("📋 Queued {} cells for {}", cells.size(), pkg) << RESET << std::endl;
     sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr); sqlite3_close(db);
 }
@@ -1,6 +1,10 @@
 #pragma once
 #include "spip_utils.h"
 
+fs::path get_queue_db_path(const Config& cfg);
 void init_queue_db(const Config& cfg);
+void advertise_wheels(const Config& cfg, const std::string& peer_url, std::set<std::string>& advertised);
+void withdraw_wheels(const Config& cfg);
+std::vector<std::pair<std::string, std::string>> find_wheel_peers(const Config& cfg, const std::string& wheel);
 void run_master(const Config& cfg, const std::vector<std::string>& args);
 void run_worker(Config& cfg);
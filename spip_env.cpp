@@ -12,13 +12,20 @@ Config init_config() {
     cfg.project_hash = compute_hash(cfg.current_project.string());
     cfg.project_env_path = cfg.envs_root / cfg.project_hash;
     cfg.db_file = cfg.spip_root / "knowledge_base.db";
+    cfg.offline = std::getenv("SPIP_OFFLINE") != nullptr;
+    cfg.snapshot_envs = std::getenv("SPIP_NO_SNAPSHOT") == nullptr;
+    cfg.forkserver = std::getenv("SPIP_NO_FORKSERVER") == nullptr;
+    cfg.matrix_cache = std::getenv("SPIP_NO_MATRIX_CACHE") == nullptr;
+    if (const char* t = std::getenv("SPIP_CELL_TIMEOUT")) cfg.matrix_cell_timeout = std::atof(t);
+    if (const char* s = std::getenv("SPIP_SPECULATE")) cfg.matrix_speculate = std::atof(s);
+    if (const char* m = std::getenv("SPIP_MIRROR")) { cfg.pypi_mirror = m; while (cfg.pypi_mirror.ends_with("/")) cfg.pypi_mirror.pop_back(); }
     return cfg;
 }
 
 void ensure_scripts(const Config& cfg) {
     fs::path scripts_dir = cfg.spip_root / "scripts";
     if (!fs::exists(scripts_dir)) fs::create_directories(scripts_dir);
-    std::vector<std::string> names = { "safe_extract.py", "audit_helper.py", "review_helper.py", "verify_helper.py", "trim_helper.py", "agent_helper.py", "pyc_profiler.py", "profile_ai_review.py" };
+    std::vector<std::string> names = { "safe_extract.py", "audit_helper.py", "review_helper.py", "verify_helper.py", "trim_helper.py", "agent_helper.py", "pyc_profiler.py", "profile_ai_review.py", "forkserver.py" };
     fs::path project_scripts = fs::current_path() / "scripts";
     if (fs::exists(project_scripts)) {
         for (const auto& name : names) {
@@ -1,12 +1,21 @@
 #pragma once
 #include "spip_utils.h"
+#include "spip_process.h"
 
 Config init_config();
 void ensure_scripts(const Config& cfg);
 void ensure_envs_tmpfs(const Config& cfg);
 void ensure_dirs(const Config& cfg);
+fs::path shard_repo_path(const Config& cfg, const std::string& key);
+fs::path git_dir_of(const fs::path& repo);
+std::string resolve_ref(const fs::path& repo, const std::string& name);
 bool branch_exists(const Config& cfg, const std::string& branch);
+bool clone_env_from_snapshot(const Config& cfg, const std::string& version, const std::string& branch);
+void store_base_snapshot(const Config& cfg, const std::string& version, const fs::path& tree, const fs::path& index);
 void setup_project_env(Config& cfg, const std::string& version = "3");
+void note_env_change(const Config& cfg, const fs::path& path);
+void forget_env_changes(const Config& cfg);   // the env was reset rather than committed
 void commit_state(const Config& cfg, const std::string& msg);
+ProcResult run_env_python(const Config& cfg, const std::vector<std::string>& args, ProcOptions opt = {});
 void exec_with_setup(Config& cfg, std::function<void(Config&)> func);
 bool require_args(const std::vector<std::string>& args, size_t min_count, const std::string& usage_msg);
@@ -1,10 +1,18 @@
 #include "spip_env_cleanup.h"
 #include "spip_utils.h"
+#include "spip_env.h"
+#include "spip_process.h"
+#include "spip_trash.h"
 
 void cleanup_envs(Config& cfg, bool all) {
     if (!fs::exists(cfg.envs_root)) return;
+    // Doomed worktrees go to the trash first; their metadata is pruned once per repo afterwards, and
+    // only then can their branches be deleted.
+    std::vector<fs::path> doomed; std::map<std::string, std::vector<std::string>> branches;
     for (const auto& entry : fs::directory_iterator(cfg.envs_root)) {
-        if (!entry.is_directory()) continue;
+        if (!entry.is_directory() && !entry.is_symlink()) continue;
+        if (entry.path().filename() == ".trash") continue;
+        if (entry.path().filename().string().starts_with(".")) { if (all) doomed.push_back(entry.path()); continue; }
         bool rem = all; std::string p;
         if (!all) {
             fs::path of = entry.path() / ".project_origin";
@@ -13,9 +21,30 @@ void cleanup_envs(Config& cfg, bool all) {
         }
         if (rem) {
             std::string h = entry.path().filename().string();
-            run_shell(std::format("cd {} && git worktree remove --force {} 2>/dev/null", quote_arg(cfg.repo_path.string()), quote_arg(entry.path().string())).c_str());
-            run_shell(std::format("cd {} && git branch -D project/{} 2>/dev/null", quote_arg(cfg.repo_path.string()), quote_arg(h)).c_str());
-            if (fs::exists(entry.path())) fs::remove_all(entry.path());
+            // Ask the worktree which repo owns it: envs made before sharding live in ~/.spip/repo.
+            ProcOptions opt; opt.quiet = true;
+            std::string repo = get_process_output({"git", "-C", entry.path().string(), "rev-parse", "--path-format=absolute", "--git-common-dir"}, opt);
+            while (!repo.empty() && std::isspace((unsigned char)repo.back())) repo.pop_back();
+            if (repo.empty() || !fs::exists(repo)) repo = shard_repo_path(cfg, h).string();
+            doomed.push_back(entry.path()); branches[repo].push_back("project/" + h);
+            if (entry.is_symlink()) doomed.push_back(fs::read_symlink(entry.path()));   // disk-tier env: the link and its target
         }
     }
+    // Per-env side files (LRU stamp, tier lock) go with their env, and stamps whose env is already gone with it.
+    for (const auto& entry : fs::directory_iterator(cfg.envs_root)) {
+        std::string n = entry.path().filename().string(); if (!n.ends_with(".used") && !n.ends_with(".lock")) continue;
+        fs::path env = cfg.envs_root / n.substr(0, n.size() - 5); std::error_code ec;
+        bool gone = std::find(doomed.begin(), doomed.end(), env) != doomed.end() || (n.ends_with(".used") && !fs::exists(fs::symlink_status(env, ec)));
+        if (gone) fs::remove(entry.path(), ec);
+    }
+    trash_paths(cfg, doomed);
+    ProcOptions opt; opt.quiet = true;
+    for (const auto& [repo, names] : branches) {
+        run_process({"git", "--git-dir=" + repo, "worktree", "prune"}, opt);
+        std::vector<std::string> del = {"git", "--git-dir=" + repo, "branch", "-D"}; del.insert(del.end(), names.begin(), names.end());
+        run_process(del, opt);
+    }
+    drain_trash(cfg);
+    if (all && fs::exists(cfg.spip_root / "repos")) fs::remove_all(cfg.spip_root / "repos");
+    if (all && fs::exists(cfg.spip_root / "envs_disk")) fs::remove_all(cfg.spip_root / "envs_disk");
 }
@@ -1,14 +1,21 @@
 #include "spip_env.h"
+#include "spip_process.h"
 
 void ensure_envs_tmpfs(const Config& cfg) {
     (void)cfg;
 #ifdef __linux__
     if (std::getenv("SPIP_NO_TMPFS")) return;
-    std::string mount_check = std::format("mount | grep {}", quote_arg(cfg.envs_root.string()));
-    if (get_exec_output(mount_check).empty()) {
+    if (get_process_output({"mount"}).find(cfg.envs_root.string()) == std::string::npos) {
         std::cout << MAGENTA << "🚀 Mounting " << cfg.envs_root << " as tmpfs for ultra-speed..." << RESET << std::endl;
-        std::string mount_cmd = std::format("sudo mount -t tmpfs -o size=2G tmpfs {}", quote_arg(cfg.envs_root.string()));
-        run_shell(mount_cmd.c_str());
+        // The RAM tier is sized from the host (SPIP_TMPFS_MB, default a quarter of MemTotal); envs that
+        // do not fit spill to ~/.spip/envs_disk (spip_env_tier.cpp) instead of failing installs.
+        long mb = 0; if (const char* e = std::getenv("SPIP_TMPFS_MB")) mb = std::atol(e);
+        else { std::ifstream mi("/proc/meminfo"); std::string k; long kb = 0; if (mi >> k >> kb && k == "MemTotal:") mb = kb / 1024 / 4; }
+        std::string size = std::format("size={}M", std::max(512L, mb));
+        ProcOptions opt; opt.foreground = true;   // sudo may ask for a password
+        std::vector<std::string> mount = {"mount", "-t", "tmpfs", "-o", size, "tmpfs", cfg.envs_root.string()};
+        if (geteuid() != 0) mount.insert(mount.begin(), "sudo");
+        run_process(mount, opt);
     }
 #endif
 }
@@ -20,8 +27,8 @@ void ensure_dirs(const Config& cfg) {
     if (!fs::exists(cfg.repo_path)) {
         std::cout << "Creating repo at: " << cfg.repo_path << std::endl;
         fs::create_directories(cfg.repo_path);
-        std::string cmd = std::format("cd {} && git init && git commit --allow-empty -m \"Initial commit\"", quote_arg(cfg.repo_path.string()));
-        run_shell(cmd.c_str());
+        ProcOptions opt; opt.cwd = cfg.repo_path;
+        if (run_process({"git", "init"}, opt) == 0) run_process({"git", "commit", "--allow-empty", "-m", "Initial commit"}, opt);
         std::ofstream gitignore(cfg.repo_path / ".gitignore");
         gitignore << "# Full environment tracking\n"; gitignore.close();
     }
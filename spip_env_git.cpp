@@ -1,13 +1,57 @@
 #include "spip_env.h"
+#include "spip_process.h"
 
 bool branch_exists(const Config& cfg, const std::string& branch) {
-    std::string cmd = std::format("cd {} && git rev-parse --verify {}", quote_arg(cfg.repo_path.string()), quote_arg(branch));
-    std::string out = get_exec_output(cmd);
-    if (out.empty() || out.find("fatal") != std::string::npos || out.find("error") != std::string::npos) return false;
-    return true;
+    fs::path repo = branch.starts_with("project/") ? shard_repo_path(cfg, branch.substr(8)) : cfg.repo_path;
+    return !resolve_ref(repo, branch).empty();
+}
+
+// Files spip wrote or removed in each env since its last commit, relative to the env root.
+// "*" means an unrecorded change, which falls back to a full `git add -A`.
+static std::mutex changes_mtx;
+static std::map<std::string, std::set<std::string>> env_changes;
+
+void note_env_change(const Config& cfg, const fs::path& path) {
+    std::string rel = path.empty() ? "*" : path.lexically_normal().lexically_relative(cfg.project_env_path).generic_string();
+    if (rel.empty() || rel == "." || rel.starts_with("..")) rel = "*";
+    std::lock_guard<std::mutex> l(changes_mtx); env_changes[cfg.project_env_path.string()].insert(rel);
+}
+
+void forget_env_changes(const Config& cfg) { std::lock_guard<std::mutex> l(changes_mtx); env_changes.erase(cfg.project_env_path.string()); }
+
+// Hands git only the changed paths: blobs for new files are written by parallel hash-object
+// workers, update-index records them (and drops removed ones), and write-tree rebuilds only
+// the trees whose cache-tree entries those paths invalidated.
+static bool commit_changes(const Config& cfg, const std::set<std::string>& changed, const std::string& msg) {
+    std::vector<std::string> blobs; std::error_code ec;
+    for (const auto& rel : changed) { fs::path p = cfg.project_env_path / rel; if (fs::is_regular_file(fs::symlink_status(p, ec))) blobs.push_back(rel); }
+    ProcOptions at_env; at_env.cwd = cfg.project_env_path; fs::path tmp = cfg.spip_root / std::format("commit_{}_{}", cfg.project_hash, getpid());
+    size_t workers = std::min<size_t>(std::max(1, cfg.concurrency), blobs.size() / 256);
+    if (workers > 1) {
+        ProcessSupervisor sup; bool ok = true; std::vector<fs::path> lists;
+        for (size_t w = 0; w < workers; ++w) {
+            lists.push_back(tmp.string() + "." + std::to_string(w));
+            { std::ofstream os(lists.back()); for (size_t i = w; i < blobs.size(); i += workers) os << blobs[i] << "\n"; }
+            ProcOptions o = at_env; o.stdin_path = lists.back(); o.silent = true;
+            sup.submit({"git", "hash-object", "-w", "--no-filters", "--stdin-paths"}, o, [&](const ProcResult& r) { if (r.status != 0) ok = false; });
+        }
+        sup.wait_all();
+        for (const auto& l : lists) fs::remove(l, ec);
+        if (!ok) return false;
+    }
+    { std::ofstream os(tmp, std::ios::binary); for (const auto& rel : changed) os << rel << '\0'; }
+    ProcOptions upd = at_env; upd.stdin_path = tmp;
+    bool ok = run_process({"git", "update-index", "-q", "--add", "--remove", "--replace", "-z", "--stdin"}, upd) == 0; fs::remove(tmp, ec);
+    if (!ok) return false;
+    std::string tree = get_process_output({"git", "write-tree"}, at_env); if (tree.empty()) return false;
+    std::string commit = get_process_output({"git", "commit-tree", tree, "-p", "HEAD", "-m", msg}, at_env); if (commit.empty()) return false;
+    return run_process({"git", "update-ref", "-m", "commit: " + msg, "HEAD", commit}, at_env) == 0;
 }
 
 void commit_state(const Config& cfg, const std::string& msg) {
-    std::string cmd = std::format("cd {} && git add -A && git commit -m {} --allow-empty", quote_arg(cfg.project_env_path.string()), quote_arg(msg));
-    run_shell(cmd.c_str());
+    std::set<std::string> changed;
+    { std::lock_guard<std::mutex> l(changes_mtx); auto it = env_changes.find(cfg.project_env_path.string()); if (it != env_changes.end()) { changed.swap(it->second); env_changes.erase(it); } }
+    if (!changed.count("*") && commit_changes(cfg, changed, msg)) return;
+    ProcOptions opt; opt.cwd = cfg.project_env_path;
+    if (run_process({"git", "add", "-A"}, opt) == 0) run_process({"git", "commit", "-m", msg, "--allow-empty"}, opt);
 }
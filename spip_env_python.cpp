@@ -0,0 +1,121 @@
+#include "spip_env.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+
+extern char** environ;
+
+// Python steps inside an env (import checks, pytest, helper scripts) go to a per-env forkserver
+// (scripts/forkserver.py) listening on ~/.spip/run/<env>.sock: the interpreter and its preloads
+// start once, each request is a fork, run with the caller's environment. The server exits after
+// SPIP_FORKSERVER_IDLE seconds without work, once its env is removed, or, when it preloaded
+// modules (SPIP_FORKSERVER_PRELOAD), once site-packages changes under them. Anything unusual (no script, old Python, socket trouble before
+// the first byte of output) falls back to spawning bin/python directly.
+
+static std::mutex& server_mutex(const std::string& sock) {
+    static std::mutex reg_mtx; static std::map<std::string, std::shared_ptr<std::mutex>> reg;
+    std::lock_guard<std::mutex> l(reg_mtx);
+    auto& p = reg[sock]; if (!p) p = std::make_shared<std::mutex>();
+    return *p;
+}
+
+static int connect_unix(const fs::path& sock) {
+    sockaddr_un addr{}; addr.sun_family = AF_UNIX;
+    if (sock.string().size() >= sizeof(addr.sun_path)) return -1;
+    sock.string().copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0); if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) { close(fd); return -1; }
+    return fd;
+}
+
+static int connect_forkserver(const Config& cfg, const fs::path& py) {
+    fs::path script = cfg.spip_root / "scripts" / "forkserver.py";
+    fs::path sock = cfg.spip_root / "run" / (cfg.project_env_path.filename().string() + ".sock");
+    int fd = connect_unix(sock); if (fd >= 0 || !fs::exists(script)) return fd;
+    std::lock_guard<std::mutex> l(server_mutex(sock.string()));
+    if ((fd = connect_unix(sock)) >= 0) return fd;
+    std::error_code ec; fs::create_directories(sock.parent_path(), ec);
+    const char* pre = std::getenv("SPIP_FORKSERVER_PRELOAD"); const char* idle = std::getenv("SPIP_FORKSERVER_IDLE");
+    ProcOptions opt; opt.silent = true; opt.quiet = true;
+    // Returns once the socket is listening; the server detaches itself. It outlives the current
+    // accounting scope, so keep it out of that scope's cgroup.
+    ProcAccount* scope = t_proc_account; t_proc_account = nullptr;
+    int rc = run_process({py.string(), script.string(), sock.string(), pre ? pre : "", idle ? idle : "300"}, opt);
+    t_proc_account = scope;
+    if (rc != 0) return -1;
+    return connect_unix(sock);
+}
+
+static bool send_all(int fd, const std::string& s) {
+    for (size_t off = 0; off < s.size(); ) {
+        ssize_t n = send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        off += n;
+    }
+    return true;
+}
+
+// Returns false only when nothing was produced yet, so the caller can still run it the slow way.
+static bool forkserver_request(int fd, const std::vector<std::string>& args, const ProcOptions& opt, ProcResult& res) {
+    std::string req;
+    auto field = [&](char tag, const std::string& v) { req += tag; req += v; req += '\0'; };
+    if (!opt.cwd.empty()) field('c', opt.cwd.string());
+    if (opt.merge_stderr) field('m', "");
+    if (t_proc_account && !t_proc_account->cgroup.empty()) field('g', t_proc_account->cgroup.string());
+    // The server's environment is whatever the first caller had: send ours, as a spawn would inherit it.
+    field('r', ""); for (char** e = environ; *e; ++e) field('e', *e);
+    for (const auto& kv : opt.env) field('e', kv);
+    for (const auto& a : args) field('a', a);
+    req += '\0';
+    if (!send_all(fd, req)) return false;
+    std::string buf; bool started = false; char chunk[65536];
+    pid_t pgid = 0; auto term_at = std::chrono::steady_clock::time_point{};
+    while (true) {
+        size_t nl = buf.find('\n');
+        if (nl != std::string::npos && nl >= 2) {
+            char tag = buf[0]; size_t n = std::strtoull(buf.c_str() + 2, nullptr, 10);
+            if (tag == 'x') {
+                std::istringstream ss(buf.substr(2, nl - 2)); long long utime = 0, stime = 0; struct rusage ru{};
+                ss >> res.status >> utime >> stime >> ru.ru_maxrss >> ru.ru_inblock >> ru.ru_oublock;
+                ru.ru_utime = { (time_t)(utime / 1000000), (suseconds_t)(utime % 1000000) }; ru.ru_stime = { (time_t)(stime / 1000000), (suseconds_t)(stime % 1000000) };
+                account_child_usage(t_proc_account, ru);
+                return true;
+            }
+            if (tag == 'p') { pgid = (pid_t)n; buf.erase(0, nl + 1); continue; }
+            if (buf.size() >= nl + 1 + n) {
+                std::string data = buf.substr(nl + 1, n); buf.erase(0, nl + 1 + n); started = true;
+                if (tag == 'o' && opt.capture) res.out += data;
+                else if (tag == 'o' && !opt.silent) std::cout << data << std::flush;
+                else if (tag == 'e' && !opt.quiet) std::cerr << data << std::flush;
+                continue;
+            }
+        }
+        if (g_interrupted) { res.status = 130 << 8; return true; }   // closing the socket interrupts the request
+        if (!enforce_deadline(t_proc_deadline, pgid, term_at) && pgid == 0 && t_proc_deadline && t_proc_deadline->expired()) {
+            t_proc_deadline->fired = true; res.status = SIGTERM; return true;   // an older server without "p": hang up instead
+        }
+        pollfd p{ fd, POLLIN, 0 };
+        if (poll(&p, 1, 200) <= 0) continue;
+        ssize_t r = recv(fd, chunk, sizeof(chunk), 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) { if (!started) return false; res.status = -1; return true; }
+        buf.append(chunk, r);
+    }
+}
+
+ProcResult run_env_python(const Config& cfg, const std::vector<std::string>& args, ProcOptions opt) {
+    fs::path py = cfg.project_env_path / "bin" / "python";
+    std::vector<std::string> argv = { py.string() }; argv.insert(argv.end(), args.begin(), args.end());
+    if (g_interrupted) { ProcResult r; r.status = 130 << 8; return r; }
+    // Interactive and redirected runs keep a real process of their own.
+    if (cfg.forkserver && !opt.foreground && opt.stdin_path.empty() && opt.stdout_path.empty()) {
+        int fd = connect_forkserver(cfg, py);
+        if (fd >= 0) {
+            ProcResult res; bool ok = forkserver_request(fd, args, opt, res); close(fd);
+            if (ok) return res;
+        }
+    }
+    if (!opt.capture) { ProcResult r; r.status = run_process(argv, opt); return r; }
+    return capture_process(argv, opt);
+}
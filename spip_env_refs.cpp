@@ -0,0 +1,55 @@
+#include "spip_env.h"
+#include "spip_process.h"
+
+// Ref lookups read loose refs and packed-refs directly instead of spawning `git rev-parse`.
+// packed-refs is parsed once per (mtime, size) and shared; loose refs are a single small read.
+// A reparse swaps in a new map, so callers keep a snapshot that no other thread will modify.
+
+using RefMap = std::map<std::string, std::string>;
+struct PackedRefs { fs::file_time_type mtime; uintmax_t size = 0; std::shared_ptr<const RefMap> refs; };
+
+static std::shared_ptr<const RefMap> packed_refs(const fs::path& git_dir) {
+    static std::mutex m; static std::map<std::string, PackedRefs> cache; static const auto none = std::make_shared<const RefMap>();
+    fs::path pf = git_dir / "packed-refs"; std::error_code ec;
+    auto mtime = fs::last_write_time(pf, ec); if (ec) return none;
+    uintmax_t size = fs::file_size(pf, ec); if (ec) return none;
+    std::lock_guard<std::mutex> l(m); PackedRefs& pr = cache[pf.string()];
+    if (pr.refs && pr.mtime == mtime && pr.size == size) return pr.refs;
+    auto refs = std::make_shared<RefMap>();
+    std::ifstream ifs(pf); std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#' || line[0] == '^') continue;
+        size_t sp = line.find(' '); if (sp != std::string::npos) (*refs)[line.substr(sp + 1)] = line.substr(0, sp);
+    }
+    pr.mtime = mtime; pr.size = size; pr.refs = std::move(refs);
+    return pr.refs;
+}
+
+static std::string read_ref(const fs::path& git_dir, const std::string& ref, int depth = 0) {
+    if (depth > 5) return "";
+    std::ifstream ifs(git_dir / ref); std::string v;
+    if (ifs && std::getline(ifs, v)) {
+        if (v.starts_with("ref: ")) return read_ref(git_dir, v.substr(5), depth + 1);
+        return v;
+    }
+    auto packed = packed_refs(git_dir); auto it = packed->find(ref);
+    return it == packed->end() ? "" : it->second;
+}
+
+fs::path git_dir_of(const fs::path& repo) { return fs::exists(repo / ".git") ? repo / ".git" : repo; }
+
+std::string resolve_ref(const fs::path& repo, const std::string& name) {
+    fs::path git_dir = git_dir_of(repo);
+    if (fs::exists(git_dir / "reftable")) {
+        ProcOptions opt; opt.quiet = true;
+        std::string out = get_process_output({"git", "--git-dir=" + git_dir.string(), "rev-parse", "--verify", "-q", name + "^{commit}"}, opt);
+        while (!out.empty() && std::isspace((unsigned char)out.back())) out.pop_back();
+        return out;
+    }
+    // Same precedence as git's own short-name lookup.
+    for (const auto& ref : { name, "refs/" + name, "refs/tags/" + name, "refs/heads/" + name, "refs/remotes/" + name }) {
+        if (ref.find("..") != std::string::npos) continue;
+        std::string v = read_ref(git_dir, ref); if (v.size() >= 40) return v;
+    }
+    return "";
+}
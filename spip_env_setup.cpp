@@ -1,25 +1,50 @@
 #include "spip_env.h"
 #include "spip_python.h"
+#include "spip_process.h"
+#include "spip_env_tier.h"
 
 void setup_project_env(Config& cfg, const std::string& version) {
-    ensure_dirs(cfg); std::string branch = "project/" + cfg.project_hash;
-    if (!branch_exists(cfg, branch)) {
+    ensure_dirs(cfg); std::string branch = "project/" + cfg.project_hash; fs::path repo = shard_repo_path(cfg, cfg.project_hash);
+    if (!cfg.project_hash.starts_with("pool_")) hold_env(cfg, cfg.project_hash);   // pool envs are held by their lease
+    // A project created before sharding keeps its branch in ~/.spip/repo: point the shard at the same
+    // commit (its objects are shared through alternates) rather than starting over from base. The old
+    // ref stays put, since it is what keeps those objects alive in the main repo.
+    if (!fs::exists(cfg.project_env_path) && repo != cfg.repo_path && !branch_exists(cfg, branch)) {
+        if (std::string legacy = resolve_ref(cfg.repo_path, branch); !legacy.empty()) {
+            std::cout << CYAN << "📦 Moving " << branch << " into its shard..." << RESET << std::endl;
+            ProcOptions opt; opt.cwd = repo;
+            run_process({"git", "update-ref", "refs/heads/" + branch, legacy}, opt);
+        }
+    }
+    if (!fs::exists(cfg.project_env_path) && !branch_exists(cfg, branch)) {
         std::string base_branch = "base/" + version;
         if (!branch_exists(cfg, base_branch)) create_base_version(cfg, version);
-        std::cout << MAGENTA << "🔨 Bootstrapping base Python " << version << "..." << RESET << std::endl;
-        create_base_version(cfg, version);
         std::cout << GREEN << "🌟 Creating new environment branch: " << branch << RESET << std::endl;
-        std::string cmd = std::format("cd {} && git branch {} {}", quote_arg(cfg.repo_path.string()), quote_arg(branch), quote_arg(base_branch));
-        run_shell(cmd.c_str());
+        ProcOptions opt; opt.cwd = repo;
+        run_process({"git", "branch", branch, resolve_ref(cfg.repo_path, base_branch)}, opt);
+    }
+    // A disk-tier env is a symlink at its usual path; a new env may be placed on disk from the start.
+    std::error_code ec; fs::path home = cfg.project_env_path;
+    if (fs::is_symlink(home) && !fs::exists(home)) fs::remove(home, ec);
+    if (fs::exists(home)) note_env_use(cfg, cfg.project_hash);
+    else if (place_env(cfg, cfg.project_hash) == EnvTier::Disk) { cfg.project_env_path = disk_tier_path(cfg, cfg.project_hash); fs::create_directories(cfg.project_env_path.parent_path(), ec); }
+    // The base snapshot only matches a branch that is still at base; a recovered branch is checked out.
+    bool at_base = resolve_ref(repo, branch) == resolve_ref(cfg.repo_path, "base/" + version);
+    if (!fs::exists(cfg.project_env_path) && at_base && clone_env_from_snapshot(cfg, version, branch)) {
+        { std::ofstream os(cfg.project_env_path / ".project_origin"); os << cfg.current_project.string(); }
+        note_env_change(cfg, cfg.project_env_path / ".project_origin");
     }
     if (!fs::exists(cfg.project_env_path)) {
         std::cout << CYAN << "📂 Linking worktree for project..." << RESET << std::endl;
-        run_shell(std::format("cd {} && git checkout main 2>/dev/null", quote_arg(cfg.repo_path.string())).c_str());
-        std::string cmd = std::format("cd {} && git worktree add {} {}", quote_arg(cfg.repo_path.string()), quote_arg(cfg.project_env_path.string()), quote_arg(branch));
-        if (run_shell(cmd.c_str()) != 0) {
-            run_shell(std::format("cd {} && git worktree prune", quote_arg(cfg.repo_path.string())).c_str());
-            run_shell(cmd.c_str());
+        ProcOptions main_opt; main_opt.cwd = cfg.repo_path; main_opt.quiet = true;
+        run_process({"git", "checkout", "main"}, main_opt);
+        ProcOptions opt; opt.cwd = repo; std::vector<std::string> add = {"git", "worktree", "add", cfg.project_env_path.string(), branch};
+        if (run_process(add, opt) != 0) {
+            run_process({"git", "worktree", "prune"}, opt);
+            run_process(add, opt);
         }
-        std::ofstream os(cfg.project_env_path / ".project_origin"); os << cfg.current_project.string();
+        { std::ofstream os(cfg.project_env_path / ".project_origin"); os << cfg.current_project.string(); }
+        note_env_change(cfg, cfg.project_env_path / ".project_origin");
     }
+    if (cfg.project_env_path != home) { fs::create_directory_symlink(cfg.project_env_path, home, ec); cfg.project_env_path = home; }
 }
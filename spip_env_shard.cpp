@@ -0,0 +1,40 @@
+#include "spip_env.h"
+#include "spip_process.h"
+
+// Project branches and their worktrees are spread over bare replicas in ~/.spip/repos/<k>, which
+// borrow every object (base venvs included) from ~/.spip/repo through alternates. Each replica has
+// its own refs, packed-refs, worktree admin dir and gc lock, so envs on different shards never
+// queue behind one another's git. The shard count is fixed at first use (repos/shards) to keep
+// the project -> shard mapping stable; with one shard everything stays in ~/.spip/repo.
+
+static int shard_count(const Config& cfg) {
+    static std::once_flag once; static int n = 1;
+    std::call_once(once, [&] {
+        fs::path pf = cfg.spip_root / "repos" / "shards";
+        { std::ifstream ifs(pf); if (ifs >> n && n >= 1) return; }
+        const char* s = std::getenv("SPIP_GIT_SHARDS");
+        n = std::clamp(s ? std::atoi(s) : (int)std::thread::hardware_concurrency(), 1, 16);
+        std::error_code ec; fs::create_directories(pf.parent_path(), ec); std::ofstream(pf) << n;
+    });
+    return n;
+}
+
+fs::path shard_repo_path(const Config& cfg, const std::string& key) {
+    int n = shard_count(cfg); if (n <= 1) return cfg.repo_path;
+    uint32_t h = 2166136261u; for (unsigned char c : key) { h ^= c; h *= 16777619u; }
+    fs::path repo = cfg.spip_root / "repos" / std::to_string(h % n);
+    static std::mutex m; static std::set<std::string> ready;
+    std::lock_guard<std::mutex> l(m); if (ready.count(repo.string())) return repo;
+    if (!fs::exists(repo / "HEAD")) {
+        fs::path tmp = repo.string() + ".tmp" + std::to_string(getpid()); std::error_code ec; fs::remove_all(tmp, ec);
+        ProcOptions opt; opt.cwd = tmp;
+        bool ok = run_process({"git", "init", "-q", "--bare", tmp.string()}) == 0 &&
+                  run_process({"git", "config", "core.trustctime", "false"}, opt) == 0 && run_process({"git", "config", "core.checkStat", "minimal"}, opt) == 0;
+        if (!ok) { fs::remove_all(tmp, ec); return cfg.repo_path; }
+        std::ofstream(tmp / "objects" / "info" / "alternates") << fs::absolute(cfg.repo_path / ".git" / "objects").string() << "\n";
+        fs::rename(tmp, repo, ec);
+        if (ec) { fs::remove_all(tmp, ec); if (!fs::exists(repo / "HEAD")) return cfg.repo_path; }
+    }
+    ready.insert(repo.string());
+    return repo;
+}
@@ -0,0 +1,100 @@
+#include "spip_env.h"
+#include "spip_process.h"
+
+// Each base/<ver> commit is kept materialized under envs/.snapshots/<ver> together with an index
+// whose stat data matches those files. A new env is then a worktree added with --no-checkout,
+// filled by reflinking (or hardlinking) the snapshot and handed a copy of that index, so git
+// never has to write or hash the venv again. Hardlinked snapshot files are made read-only; the
+// few files that are edited in place get their own copy.
+
+static const std::vector<std::string> copy_up_files = { "pyvenv.cfg", "bin/activate", "bin/activate.csh", "bin/activate.fish", "bin/Activate.ps1" };
+
+static std::string safe_version(const std::string& version) {
+    std::string safe_v; for (char c : version) if (std::isalnum(c) || c == '.') safe_v += c;
+    return safe_v;
+}
+
+static void seal_snapshot(const Config& cfg, const fs::path& snap) {
+    // Clones get fresh inodes and ctimes; without these the first git status re-hashes the whole venv.
+    ProcOptions opt; opt.cwd = cfg.repo_path;
+    run_process({"git", "config", "core.trustctime", "false"}, opt); run_process({"git", "config", "core.checkStat", "minimal"}, opt);
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(snap, ec); it != fs::recursive_directory_iterator(); it.increment(ec))
+        if (it->is_regular_file(ec) && !it->is_symlink(ec)) fs::permissions(it->path(), fs::perms::owner_write | fs::perms::group_write | fs::perms::others_write, fs::perm_options::remove, ec);
+}
+
+static std::mutex& snapshot_mutex(const std::string& safe_v) {
+    static std::mutex reg_mtx; static std::map<std::string, std::shared_ptr<std::mutex>> reg;
+    std::lock_guard<std::mutex> l(reg_mtx);
+    auto& p = reg[safe_v]; if (!p) p = std::make_shared<std::mutex>();
+    return *p;
+}
+
+void store_base_snapshot(const Config& cfg, const std::string& version, const fs::path& tree, const fs::path& index) {
+    std::string safe_v = safe_version(version); fs::path dir = cfg.envs_root / ".snapshots"; fs::path snap = dir / safe_v;
+    std::string commit = resolve_ref(cfg.repo_path, "base/" + version); std::error_code ec;
+    if (!cfg.snapshot_envs || commit.empty() || fs::exists(snap)) { fs::remove_all(tree, ec); fs::remove(index, ec); return; }
+    fs::create_directories(dir, ec);
+    fs::rename(tree, snap, ec);
+    if (ec) { fs::remove_all(tree, ec); fs::remove(index, ec); return; }
+    fs::rename(index, dir / (safe_v + ".index"), ec);
+    if (ec) { fs::remove_all(snap, ec); fs::remove(index, ec); return; }
+    std::ofstream(dir / (safe_v + ".commit")) << commit;
+    seal_snapshot(cfg, snap);
+}
+
+static fs::path ensure_base_snapshot(const Config& cfg, const std::string& version) {
+    std::string safe_v = safe_version(version); fs::path dir = cfg.envs_root / ".snapshots"; fs::path snap = dir / safe_v;
+    std::string commit = resolve_ref(cfg.repo_path, "base/" + version); if (commit.empty()) return {};
+    std::lock_guard<std::mutex> l(snapshot_mutex(safe_v));
+    std::string have; { std::ifstream ifs(dir / (safe_v + ".commit")); std::getline(ifs, have); }
+    if (have == commit && fs::exists(snap) && fs::exists(dir / (safe_v + ".index"))) return snap;
+    std::cout << CYAN << "📸 Materializing base snapshot for Python " << version << "..." << RESET << std::endl;
+    std::error_code ec; fs::create_directories(dir, ec);
+    std::string tag = std::format("{}.tmp{}", safe_v, getpid()); fs::path tmp = dir / tag; fs::path tmp_index = dir / (tag + ".index");
+    fs::remove_all(tmp, ec); fs::create_directories(tmp, ec);
+    ProcOptions opt; opt.cwd = cfg.repo_path; opt.env = { "GIT_INDEX_FILE=" + tmp_index.string() }; opt.quiet = true;
+    if (run_process({"git", "--work-tree=" + tmp.string(), "checkout", "-q", "-f", commit, "--", "."}, opt) != 0) { fs::remove_all(tmp, ec); fs::remove(tmp_index, ec); return {}; }
+    fs::remove(dir / (safe_v + ".commit"), ec); fs::remove_all(snap, ec);
+    fs::rename(tmp, snap, ec); if (!ec) fs::rename(tmp_index, dir / (safe_v + ".index"), ec);
+    if (ec) { fs::remove_all(tmp, ec); fs::remove(tmp_index, ec); return {}; }
+    std::ofstream(dir / (safe_v + ".commit")) << commit;
+    seal_snapshot(cfg, snap);
+    return snap;
+}
+
+bool clone_env_from_snapshot(const Config& cfg, const std::string& version, const std::string& branch) {
+    if (!cfg.snapshot_envs) return false;
+    fs::path snap = ensure_base_snapshot(cfg, version); if (snap.empty()) return false;
+    fs::path index = snap.parent_path() / (snap.filename().string() + ".index");
+    std::string env = cfg.project_env_path.string(); std::error_code ec;
+    ProcOptions at_repo; at_repo.cwd = shard_repo_path(cfg, cfg.project_hash); at_repo.quiet = true;
+    std::vector<std::string> add = {"git", "worktree", "add", "-q", "--no-checkout", env, branch};
+    if (run_process(add, at_repo) != 0) {
+        run_process({"git", "worktree", "prune"}, at_repo);
+        if (run_process(add, at_repo) != 0) return false;
+    }
+    auto abandon = [&] {
+        run_process({"git", "worktree", "remove", "--force", env}, at_repo);
+        fs::remove_all(cfg.project_env_path, ec); return false;
+    };
+    std::string line; { std::ifstream ifs(cfg.project_env_path / ".git"); std::getline(ifs, line); }
+    if (!line.starts_with("gitdir: ")) return abandon();
+    fs::path gitdir = line.substr(8); if (gitdir.is_relative()) gitdir = cfg.project_env_path / gitdir;
+    std::string src = (snap / ".").string(); fs::path probe = cfg.project_env_path / ".reflink_probe"; ProcOptions q; q.quiet = true;
+    bool reflink = run_process({"cp", "--reflink=always", (snap / "pyvenv.cfg").string(), probe.string()}, q) == 0;
+    fs::remove(probe, ec);
+    bool cloned = reflink ? run_process({"cp", "-a", "--reflink=always", src, env}, q) == 0 && run_process({"chmod", "-R", "u+w", env}, q) == 0
+                          : run_process({"cp", "-al", src, env}, q) == 0;
+    if (!cloned) return abandon();
+    if (!reflink) for (const auto& rel : copy_up_files) {
+        fs::path p = cfg.project_env_path / rel; if (!fs::is_regular_file(p, ec)) continue;
+        fs::path tmp = p; tmp += ".cow";
+        fs::copy_file(p, tmp, fs::copy_options::overwrite_existing, ec);
+        if (!ec) fs::permissions(tmp, fs::perms::owner_write, fs::perm_options::add, ec);
+        if (!ec) fs::rename(tmp, p, ec);
+        if (ec) fs::remove(tmp, ec);
+    }
+    fs::copy_file(index, gitdir / "index", fs::copy_options::overwrite_existing, ec);
+    return ec ? abandon() : true;
+}
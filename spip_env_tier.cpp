@@ -0,0 +1,112 @@
+#include "spip_env_tier.h"
+#include "ResourceProfiler.h"
+#include "spip_process.h"
+#include <sys/file.h>
+#include <sys/statvfs.h>
+#include <fcntl.h>
+#include <utility>
+#ifdef __linux__
+#include <sys/vfs.h>
+#include <linux/magic.h>
+#endif
+
+static std::mutex m_tier;
+static TierStats stats;
+static std::vector<TierEvent> events;
+
+static void record(const std::string& env, const std::string& tier, const std::string& event, uintmax_t bytes = 0) {
+    events.push_back({std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count(), env, tier, event, bytes});
+}
+
+static long env_knob(const char* name, long def) { const char* e = std::getenv(name); return e ? std::atol(e) : def; }
+
+bool ram_tier_active(const Config& cfg) {
+#ifdef __linux__
+    struct statfs sf; return statfs(cfg.envs_root.c_str(), &sf) == 0 && sf.f_type == TMPFS_MAGIC;
+#else
+    (void)cfg; return false;
+#endif
+}
+
+fs::path disk_tier_path(const Config& cfg, const std::string& name) { return cfg.spip_root / "envs_disk" / name; }
+
+// True when `need` more bytes keep the tmpfs at or under `pct` percent full.
+static bool fits(const Config& cfg, uintmax_t need, long pct) {
+    struct statvfs vf; if (statvfs(cfg.envs_root.c_str(), &vf) != 0) return true;
+    uintmax_t total = (uintmax_t)vf.f_blocks * vf.f_frsize, used = total - (uintmax_t)vf.f_bavail * vf.f_frsize;
+    return used + need <= total / 100 * pct;
+}
+
+static void touch_stamp(const Config& cfg, const std::string& name) { std::ofstream(cfg.envs_root / (name + ".used")).close(); }
+
+void hold_env(const Config& cfg, const std::string& name) {
+    static std::mutex m; static std::set<std::string> held;
+    std::lock_guard<std::mutex> l(m); if (held.count(name)) return;
+    int fd = open((cfg.envs_root / (name + ".lock")).c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd >= 0 && flock(fd, LOCK_SH) == 0) held.insert(name);   // kept open until exit
+    else if (fd >= 0) close(fd);
+}
+
+// Copies an env to the disk tier and leaves a symlink behind. Every env is moved only while we hold
+// its lock exclusively, so never under a pool lease or a spip process working in it; non-pool envs
+// also have to be SPIP_TIER_IDLE seconds (default 600) unused. cp -a keeps mtimes, so the git
+// index of the moved env stays clean.
+static bool spill_one(const Config& cfg, const std::string& name) {
+    fs::path src = cfg.envs_root / name, dst = disk_tier_path(cfg, name), part = dst.string() + ".part";
+    std::error_code ec; uintmax_t bytes = get_dir_size(src);
+    fs::remove_all(part, ec); fs::create_directories(dst.parent_path(), ec);
+    ProcOptions q; q.quiet = true;
+    if (run_process({"cp", "-a", src.string(), part.string()}, q) != 0) { fs::remove_all(part, ec); return false; }
+    fs::remove_all(dst, ec); fs::rename(part, dst, ec); if (ec) { fs::remove_all(part, ec); return false; }
+    fs::remove_all(src, ec);   // synchronously: the point is to free RAM now
+    fs::create_directory_symlink(dst, src, ec);
+    ++stats.spills; stats.spilled_bytes += bytes; record(name, "disk", "spill", bytes);
+    std::cout << MAGENTA << std::format("🗄  Spilled env {} to disk ({:.0f} MB)", name, bytes / 1048576.0) << RESET << std::endl;
+    return true;
+}
+
+static void spill_lru(const Config& cfg, const std::string& keep, uintmax_t need) {
+    long low = env_knob("SPIP_TIER_LOW", 70), idle = env_knob("SPIP_TIER_IDLE", 600);
+    auto now = fs::file_time_type::clock::now();
+    std::vector<std::pair<fs::file_time_type, std::string>> lru; std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(cfg.envs_root, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name == keep || name.starts_with(".") || entry.is_symlink() || !entry.is_directory()) continue;
+        fs::path stamp = cfg.envs_root / (name + ".used");
+        auto used = fs::last_write_time(fs::exists(stamp) ? stamp : entry.path(), ec);
+        if (!name.starts_with("pool_") && now - used < std::chrono::seconds(idle)) continue;
+        lru.emplace_back(used, name);
+    }
+    std::sort(lru.begin(), lru.end());
+    for (const auto& [used, name] : lru) {
+        if (fits(cfg, need, low)) break;
+        int fd = open((cfg.envs_root / (name + ".lock")).c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+        if (fd < 0 || flock(fd, LOCK_EX | LOCK_NB) != 0) { if (fd >= 0) close(fd); continue; }   // in use right now
+        spill_one(cfg, name);
+        close(fd);
+    }
+}
+
+EnvTier place_env(const Config& cfg, const std::string& name) {
+    touch_stamp(cfg, name);
+    if (!ram_tier_active(cfg)) return EnvTier::Ram;   // one tier: everything lives in envs/
+    long high = env_knob("SPIP_TIER_HIGH", 85); uintmax_t need = (uintmax_t)env_knob("SPIP_ENV_ESTIMATE_MB", 300) * 1048576;
+    std::lock_guard<std::mutex> l(m_tier);
+    if (!fits(cfg, need, high)) spill_lru(cfg, name, need);
+    if (fits(cfg, need, high)) { ++stats.ram_placements; record(name, "ram", "place"); return EnvTier::Ram; }
+    ++stats.disk_placements; record(name, "disk", "place");
+    std::cout << MAGENTA << "🗄  RAM tier full: placing env " << name << " on disk" << RESET << std::endl;
+    return EnvTier::Disk;
+}
+
+void note_env_use(const Config& cfg, const std::string& name) {
+    touch_stamp(cfg, name);
+    if (!ram_tier_active(cfg)) return;
+    bool disk = fs::is_symlink(cfg.envs_root / name);
+    std::lock_guard<std::mutex> l(m_tier);
+    ++(disk ? stats.disk_hits : stats.ram_hits); record(name, disk ? "disk" : "ram", "hit");
+}
+
+TierStats tier_stats() { std::lock_guard<std::mutex> l(m_tier); return stats; }
+
+std::vector<TierEvent> take_tier_events() { std::lock_guard<std::mutex> l(m_tier); return std::exchange(events, {}); }
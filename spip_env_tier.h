@@ -0,0 +1,21 @@
+#pragma once
+#include "spip_utils.h"
+
+// Tiered env storage. When ensure_envs_tmpfs has mounted ~/.spip/envs as a tmpfs it is the RAM
+// tier and ~/.spip/envs_disk is the disk tier. An env always answers at envs/<name>: a disk-tier
+// env is a symlink there, so nothing else needs to know where it lives. A new env goes to RAM if
+// the tmpfs stays under SPIP_TIER_HIGH percent full (default 85) with room reserved for it
+// (SPIP_ENV_ESTIMATE_MB, default 300). Otherwise least-recently-used idle envs are spilled to disk
+// until usage is back at SPIP_TIER_LOW (default 70), and only if that is not enough does the new
+// env itself go to disk.
+enum class EnvTier { Ram, Disk };
+struct TierEvent { double at; std::string env, tier, event; uintmax_t bytes; };
+struct TierStats { long ram_hits = 0, disk_hits = 0, ram_placements = 0, disk_placements = 0, spills = 0; uintmax_t spilled_bytes = 0; };
+
+bool ram_tier_active(const Config& cfg);
+EnvTier place_env(const Config& cfg, const std::string& name);   // tier for a new env; may spill others first
+fs::path disk_tier_path(const Config& cfg, const std::string& name);
+void note_env_use(const Config& cfg, const std::string& name);   // LRU stamp and tier hit for an existing env
+void hold_env(const Config& cfg, const std::string& name);       // shared <name>.lock for the rest of the process: no spill under us
+TierStats tier_stats();
+std::vector<TierEvent> take_tier_events();
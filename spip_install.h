@@ -3,8 +3,13 @@
 
 int score_wheel(const std::string& url, const std::string& target_py = "3.12");
 fs::path get_cached_wheel_path(const Config& cfg, const PackageInfo& info);
+std::vector<std::string> get_wheel_sources(const Config& cfg, const PackageInfo& info);
+bool try_delta_upgrade(const Config& cfg, const PackageInfo& info, const fs::path& dest);
+bool download_wheel(const Config& cfg, const PackageInfo& info, const fs::path& dest, bool quiet = false);
 PackageInfo get_package_info(const std::string& pkg, const std::string& version = "", const std::string& target_py = "3.12");
 bool resolve_and_install(const Config& cfg, const std::vector<std::string>& targets, const std::string& version = "", const std::string& target_py = "3.12");
+bool install_packages(const Config& cfg, const std::map<std::string, PackageInfo>& resolved);
+bool fetch_wheel(const Config& cfg, const PackageInfo& info);
 void uninstall_package(const Config& cfg, const std::string& pkg);
 void prune_orphans(const Config& cfg);
 void record_manual_install(const Config& cfg, const std::string& pkg, bool add);
@@ -0,0 +1,49 @@
+#include "spip_install.h"
+#include "spip_delta_db.h"
+#include "spip_process.h"
+
+// Rebuilds a wheel from an older cached version plus a VCDIFF delta (see `spip diff --store`).
+// Deltas come from the local delta_cache, SPIP_DELTA_SOURCE (a directory or URL), or the
+// /deltas route of a plain-HTTP spip serve mirror; offline, only from local ones. The result must
+// match the PyPI sha256.
+bool try_delta_upgrade(const Config& cfg, const PackageInfo& info, const fs::path& dest) {
+    if (info.sha256.empty()) return false;
+    auto parse_ver = [](std::string_view s) {
+        std::vector<int> parts; std::string part;
+        for (char c : s) { if (isdigit(c)) part += c; else { if (!part.empty()) parts.push_back(std::stoi(part)); part = ""; } }
+        if (!part.empty()) parts.push_back(std::stoi(part));
+        return parts;
+    };
+    std::string prefix = info.name + "-"; std::vector<std::string> cached; std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(cfg.spip_root, ec)) {
+        std::string n = entry.path().filename().string();
+        if (!n.starts_with(prefix) || !n.ends_with(".whl") || !entry.is_regular_file()) continue;
+        std::string v = n.substr(prefix.size(), n.size() - prefix.size() - 4);
+        if (v != info.version && !v.empty() && isdigit(v[0])) cached.push_back(v);
+    }
+    if (cached.empty()) return false;
+    std::optional<DeltaRecord> best;
+    for (const auto& v : cached) {
+        auto rec = query_delta(info.name, v, info.version);
+        if (rec && is_delta_beneficial(*rec) && (!best || rec->delta_size < best->delta_size)) best = rec;
+    }
+    const char* src_env = std::getenv("SPIP_DELTA_SOURCE");
+    std::string remote = src_env ? src_env : (cfg.pypi_mirror.starts_with("http://") ? cfg.pypi_mirror + "/deltas" : "");
+    if (cfg.offline && !fs::is_directory(remote)) remote.clear();
+    if (!best && remote.empty()) return false;
+    std::string from = best ? best->source_version : *std::max_element(cached.begin(), cached.end(), [&](const auto& a, const auto& b) { return parse_ver(a) < parse_ver(b); });
+    std::string delta_name = best ? fs::path(best->delta_path).filename().string() : std::format("{}_{}_to_{}.vcdiff", info.name, from, info.version);
+    fs::path delta = dest.string() + ".vcdiff"; bool fetched = false;
+    if (best && fs::exists(best->delta_path)) delta = best->delta_path;
+    else if (!remote.empty() && fs::is_directory(remote)) delta = fs::path(remote) / delta_name;
+    else if (!remote.empty()) fetched = run_process({"curl", "-f", "-s", "-L", "--connect-timeout", "5", "--max-time", "120", remote + "/" + delta_name, "-o", delta.string()}) == 0;
+    if (!fs::exists(delta)) return false;
+    fs::path source = cfg.spip_root / (info.name + "-" + from + ".whl"); uintmax_t delta_kb = fs::file_size(delta, ec) / 1024;
+    ProcOptions q; q.quiet = true;
+    bool ok = run_process({"xdelta3", "-d", "-f", "-s", source.string(), delta.string(), dest.string()}, q) == 0
+              && fs::exists(dest) && compute_file_sha256(dest) == info.sha256;
+    if (fetched) fs::remove(delta, ec);
+    if (!ok) { fs::remove(dest, ec); return false; }
+    std::cout << GREEN << "🧬 Rebuilt " << info.name << " " << info.version << " from " << from << " + " << delta_kb << " KB delta." << RESET << std::endl;
+    return true;
+}
@@ -4,7 +4,13 @@
 
 PackageInfo get_package_info(const std::string& pkg, const std::string& version, const std::string& target_py) {
     fs::path db_file = get_db_path(pkg);
-    if (!fs::exists(db_file)) { static std::set<std::string> shown; if (!shown.count(pkg)) { std::cout << YELLOW << "⚠️ Metadata for " << pkg << " not in local DB. Fetching..." << RESET << std::endl; shown.insert(pkg); } Config cfg = init_config(); fetch_package_metadata(cfg, pkg); }
+    if (!fs::exists(db_file)) {
+        Config cfg = init_config(); bool skip = cfg.offline || is_known_missing("pkg:" + db_file.stem().string());
+        static std::mutex m_shown; static std::set<std::string> shown;
+        { std::lock_guard<std::mutex> l(m_shown); if (!shown.count(pkg)) { std::cout << YELLOW << "⚠️ Metadata for " << pkg << " not in local DB. " << (skip ? (cfg.offline ? "Skipping (offline)." : "Skipping (known missing).") : "Fetching...") << RESET << std::endl; shown.insert(pkg); } }
+        if (skip) return PackageInfo{};
+        fetch_package_metadata(cfg, pkg);
+    }
     std::ifstream ifs(db_file); std::string content((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
     PackageInfo info; if (content.empty()) return info; info.name = pkg;
     if (version.empty()) {
@@ -32,8 +38,10 @@ PackageInfo get_package_info(const std::string& pkg, const std::string& version,
             while (cur < content.size() && bal > 0) { if (content[cur] == '[') bal++; else if (content[cur] == ']') bal--; cur++; }
             std::string release_data = content.substr(content.find("[", ver_entry), cur - content.find("[", ver_entry));
             std::regex url_re(R"(\"url\":\s*\"(https\://[^\"]*\.whl)\")"); auto wheels_begin = std::sregex_iterator(release_data.begin(), release_data.end(), url_re);
-            int best_score = -1; for (auto it = wheels_begin; it != std::sregex_iterator(); ++it) {
-                std::string url = (*it)[1].str(); int s = score_wheel(url, target_py); if (s > best_score) { best_score = s; info.wheel_url = url; }
+            int best_score = -1; size_t prev_end = 0; for (auto it = wheels_begin; it != std::sregex_iterator(); ++it) {
+                std::string url = (*it)[1].str(); int s = score_wheel(url, target_py);
+                std::string file_obj = release_data.substr(prev_end, it->position() - prev_end); prev_end = it->position() + it->length();
+                if (s > best_score) { best_score = s; info.wheel_url = url; info.sha256 = extract_field(file_obj, "sha256"); }
             }
         }
     }
@@ -13,6 +13,10 @@ bool resolve_and_install(const Config& cfg, const std::vector<std::string>& targ
         if (info.wheel_url.empty()) { std::cout << RED << "❌ Could not find wheel URL for " << name << RESET << std::endl; continue; }
         resolved[low] = info; installed.insert(low); for (const auto& d : info.dependencies) queue.push_back(d);
     }
+    return install_packages(cfg, resolved);
+}
+
+bool install_packages(const Config& cfg, const std::map<std::string, PackageInfo>& resolved) {
     fs::path sp = get_site_packages(cfg); if (sp.empty()) { std::cerr << RED << "❌ Could not find site-packages directory." << RESET << std::endl; return false; }
     std::cout << GREEN << "🚀 Installing " << resolved.size() << " packages..." << RESET << std::endl;
     bool all_ok = true; int current = 0;
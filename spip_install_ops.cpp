@@ -1,4 +1,5 @@
 #include "spip_install.h"
+#include "spip_env.h"
 
 void uninstall_package(const Config& cfg, const std::string& pkg) {
     fs::path sp = get_site_packages(cfg); if (sp.empty()) return;
@@ -14,12 +15,13 @@ void uninstall_package(const Config& cfg, const std::string& pkg) {
         std::ifstream ifs(record); std::string line; while (std::getline(ifs, line)) {
             size_t comma = line.find(','); if (comma != std::string::npos) {
                 fs::path full = sp / line.substr(0, comma); if (fs::exists(full) && !fs::is_directory(full)) {
-                    fs::remove(full); fs::path p = full.parent_path();
+                    fs::remove(full); note_env_change(cfg, full); fs::path p = full.parent_path();
                     while (p != sp && fs::exists(p) && fs::is_empty(p)) { fs::remove(p); p = p.parent_path(); }
                 }
             }
         }
     }
+    if (fs::exists(dist)) for (const auto& entry : fs::recursive_directory_iterator(dist)) if (!entry.is_directory()) note_env_change(cfg, entry.path());
     fs::remove_all(dist);
 }
 
@@ -29,4 +31,5 @@ void record_manual_install(const Config& cfg, const std::string& pkg, bool add)
     std::string low = pkg; std::transform(low.begin(), low.end(), low.begin(), ::tolower);
     if (add) pkgs.insert(low); else pkgs.erase(low);
     std::ofstream ofs(f); for (const auto& p : pkgs) ofs << p << "\n";
+    note_env_change(cfg, f);
 }
@@ -1,28 +1,51 @@
 #include "spip_install.h"
+#include "spip_db.h"
+#include "spip_env.h"
+#include "spip_process.h"
 
-bool install_single_package(const Config& cfg, const PackageInfo& info, const fs::path& sp) {
+// The wheel RECORD lists every member safe_extract wrote, which is the env's change set.
+static void note_wheel_files(const Config& cfg, const PackageInfo& info, const fs::path& sp) {
+    std::string norm = info.name; std::transform(norm.begin(), norm.end(), norm.begin(), ::tolower); std::replace(norm.begin(), norm.end(), '-', '_'); std::replace(norm.begin(), norm.end(), '.', '_');
+    fs::path record; for (const auto& entry : fs::directory_iterator(sp)) {
+        std::string n = entry.path().filename().string(); std::transform(n.begin(), n.end(), n.begin(), ::tolower);
+        if (n.starts_with(norm + "-" + info.version) && n.ends_with(".dist-info")) { record = entry.path() / "RECORD"; break; }
+    }
+    std::ifstream ifs(record); if (record.empty() || !ifs) { note_env_change(cfg, {}); return; }
+    std::string line; while (std::getline(ifs, line)) { size_t comma = line.find(','); if (comma != std::string::npos && comma > 0) note_env_change(cfg, sp / line.substr(0, comma)); }
+}
+
+bool fetch_wheel(const Config& cfg, const PackageInfo& info) {
     fs::path whl = cfg.spip_root / (info.name + "-" + info.version + ".whl");
+    if (fs::exists(whl) && fs::file_size(whl) > 0) return true;
+    // Offline, a stored delta against a cached version can still rebuild the wheel.
+    auto missing = [&] { std::cerr << RED << "❌ Wheel for " << info.name << " " << info.version << " not in cache" << (cfg.offline ? " (offline)." : " (known missing).") << RESET << std::endl; return false; };
+    if (!cfg.offline && is_known_missing("whl:" + info.wheel_url)) return missing();
+    static std::mutex m_reg; static std::map<std::string, std::shared_ptr<std::mutex>> locks;
+    std::shared_ptr<std::mutex> wheel_lock; { std::lock_guard<std::mutex> l(m_reg); if (locks.find(info.wheel_url) == locks.end()) locks[info.wheel_url] = std::make_shared<std::mutex>(); wheel_lock = locks[info.wheel_url]; }
+    std::lock_guard<std::mutex> l(*wheel_lock);
     if (!fs::exists(whl) || fs::file_size(whl) == 0) {
-        static std::mutex m_reg; static std::map<std::string, std::shared_ptr<std::mutex>> locks;
-        std::shared_ptr<std::mutex> wheel_lock; { std::lock_guard<std::mutex> l(m_reg); if (locks.find(info.wheel_url) == locks.end()) locks[info.wheel_url] = std::make_shared<std::mutex>(); wheel_lock = locks[info.wheel_url]; }
-        std::lock_guard<std::mutex> l(*wheel_lock);
-        if (!fs::exists(whl) || fs::file_size(whl) == 0) {
-            fs::path part = whl.string() + ".part." + std::to_string(getpid());
-            bool quiet = (std::thread::hardware_concurrency() > 8);
-            std::string dl = std::format("timeout 300 curl -f -L --connect-timeout 10 --max-time 240 -s {} {} -o {}", quiet ? "" : "-#", quote_arg(info.wheel_url), quote_arg(part.string()));
-            if (run_shell(dl.c_str()) == 0 && fs::exists(part) && fs::file_size(part) > 0) fs::rename(part, whl);
-            else { if (fs::exists(part)) fs::remove(part); return false; }
-        }
+        fs::path part = whl.string() + ".part." + std::to_string(getpid());
+        bool quiet = (std::thread::hardware_concurrency() > 8);
+        if (download_wheel(cfg, info, part, quiet)) fs::rename(part, whl);
+        else return cfg.offline ? missing() : false;
     }
+    return true;
+}
+
+bool install_single_package(const Config& cfg, const PackageInfo& info, const fs::path& sp) {
+    fs::path whl = cfg.spip_root / (info.name + "-" + info.version + ".whl");
+    if (!fetch_wheel(cfg, info)) return false;
     fs::path helper = cfg.spip_root / "scripts" / "safe_extract.py"; fs::path py = cfg.project_env_path / "bin" / "python";
-    std::string ext = std::format("{} {} {} {}", quote_arg(py.string()), quote_arg(helper.string()), quote_arg(whl.string()), quote_arg(sp.string()));
-    int ret = run_shell(ext.c_str());
+    std::vector<std::string> ext = {py.string(), helper.string(), whl.string(), sp.string()};
+    int ret = run_process(ext);
     if (ret != 0) {
         std::cerr << YELLOW << "⚠️ Extraction failed for " << info.name << ". Retrying hardened download..." << RESET << std::endl;
         if (fs::exists(whl)) fs::remove(whl);
-        std::string dl = std::format("timeout 300 curl -f -L --connect-timeout 10 --max-time 240 -s -# {} -o {}", quote_arg(info.wheel_url), quote_arg(whl.string()));
-        if (run_shell(dl.c_str()) == 0 && fs::exists(whl)) ret = run_shell(ext.c_str());
-        if (ret != 0) { std::cerr << RED << "❌ Installation failed for " << info.name << "." << RESET << std::endl; if (fs::exists(whl)) fs::remove(whl); return false; }
+        if (cfg.offline) { std::cerr << RED << "❌ Installation failed for " << info.name << " (offline, cannot re-download)." << RESET << std::endl; return false; }
+        std::vector<std::string> dl = {"timeout", "300", "curl", "-f", "-L", "--connect-timeout", "10", "--max-time", "240", "-s", "-#", info.wheel_url, "-o", whl.string()};
+        if (run_process(dl) == 0 && fs::exists(whl)) ret = run_process(ext);
+        if (ret != 0) { std::cerr << RED << "❌ Installation failed for " << info.name << "." << RESET << std::endl; if (fs::exists(whl)) fs::remove(whl); note_env_change(cfg, {}); return false; }
     }
+    note_wheel_files(cfg, info, sp);
     return true;
 }
@@ -1,4 +1,7 @@
 #include "spip_install.h"
+#include "spip_db.h"
+#include "spip_distributed.h"
+#include "spip_process.h"
 
 int score_wheel(const std::string& url, const std::string& target_py) {
     int score = 0; std::string lower = url; std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
@@ -17,3 +20,41 @@ int score_wheel(const std::string& url, const std::string& target_py) {
 fs::path get_cached_wheel_path(const Config& cfg, const PackageInfo& info) {
     return cfg.spip_root / (info.name + "-" + info.version + ".whl");
 }
+
+// The cache keys wheels by name and version only; the upstream filename (with its PEP 427 tags)
+// is kept beside it in <wheel>.name so `spip serve` can publish the wheel under its real name.
+static void note_wheel_filename(const Config& cfg, const PackageInfo& info) {
+    if (info.wheel_url.empty()) return;
+    std::ofstream(get_cached_wheel_path(cfg, info).string() + ".name") << info.wheel_url.substr(info.wheel_url.rfind('/') + 1);
+}
+
+std::vector<std::string> get_wheel_sources(const Config& cfg, const PackageInfo& info) {
+    std::vector<std::string> sources;
+    // A plain-HTTP mirror is a LAN `spip serve`, which exposes its wheel cache under /wheels.
+    if (cfg.pypi_mirror.starts_with("http://")) sources.push_back(std::format("{}/wheels/{}-{}.whl", cfg.pypi_mirror, info.name, info.version));
+    sources.push_back(info.wheel_url);
+    return sources;
+}
+
+bool download_wheel(const Config& cfg, const PackageInfo& info, const fs::path& dest, bool quiet) {
+    if (try_delta_upgrade(cfg, info, dest)) { note_wheel_filename(cfg, info); return true; }
+    if (cfg.offline) return false;
+    std::vector<std::pair<std::string, std::string>> sources;
+    if (cfg.peer_sharing) sources = find_wheel_peers(cfg, get_cached_wheel_path(cfg, info).filename().string());
+    for (const auto& src : get_wheel_sources(cfg, info)) sources.push_back({src, ""});
+    bool gone = false; std::error_code ec;   // gone: the upstream URL itself answered 404/410
+    for (const auto& [src, peer_sha] : sources) {
+        std::vector<std::string> argv = {"timeout", "300", "curl", "-f", "-L", "--connect-timeout", "10", "--max-time", "240", "-s", "-w", "%{http_code}", src, "-o", dest.string()};
+        if (!quiet) argv.insert(argv.begin() + 10, "-#");
+        ProcResult r = capture_process(argv);
+        if (src == info.wheel_url) gone = r.out == "404" || r.out == "410";
+        if (r.status != 0 || !fs::exists(dest) || fs::file_size(dest) == 0) continue;
+        std::string want = info.sha256.empty() ? peer_sha : info.sha256;
+        if (want.empty() || compute_file_sha256(dest) == want) { note_wheel_filename(cfg, info); return true; }
+        std::cerr << YELLOW << "⚠️ Digest mismatch for " << src << ", discarding." << RESET << std::endl;
+        fs::remove(dest, ec); gone = false;
+    }
+    fs::remove(dest, ec);
+    if (gone) mark_missing("whl:" + info.wheel_url);
+    return false;
+}
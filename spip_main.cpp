@@ -6,7 +6,11 @@ void signal_handler(int) { g_interrupted = true; }
 int main(int argc, char* argv[]) {
     std::signal(SIGINT, signal_handler);
     std::vector<std::string> args;
-    for (int i = 1; i < argc; ++i) args.push_back(argv[i]);
+    // --offline is a global flag: only before the subcommand, so `spip run script.py --offline` keeps it.
+    for (int i = 1; i < argc; ++i) {
+        if (args.empty() && std::string(argv[i]) == "--offline") setenv("SPIP_OFFLINE", "1", 1);
+        else args.push_back(argv[i]);
+    }
     Config cfg = init_config();
     run_command(cfg, args);
     return 0;
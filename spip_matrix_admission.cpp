@@ -0,0 +1,78 @@
+#include "spip_matrix_admission.h"
+#include "spip_install.h"
+#include <sys/statvfs.h>
+#ifdef __linux__
+#include <sys/vfs.h>
+#include <linux/magic.h>
+#endif
+
+long mem_available_kb() {
+    std::ifstream ifs("/proc/meminfo"); std::string key; long kb = 0; std::string unit;
+    while (ifs >> key >> kb >> unit) if (key == "MemAvailable:") return kb;
+    return -1;
+}
+
+uintmax_t unpacked_bytes(const Config& cfg, const std::map<std::string, PackageInfo>& closure) {
+    uintmax_t total = 0;
+    for (const auto& [id, info] : closure) { std::error_code ec; auto sz = fs::file_size(get_cached_wheel_path(cfg, info), ec); if (!ec) total += 3 * sz; }   // unpacked ~3x the wheel
+    return total;
+}
+
+double memory_pressure_avg10() {
+    std::ifstream ifs("/proc/pressure/memory"); std::string line;
+    while (std::getline(ifs, line)) if (line.starts_with("some ")) {
+        size_t a = line.find("avg10="); if (a != std::string::npos) return std::strtod(line.c_str() + a + 6, nullptr);
+    }
+    return 0;
+}
+
+MemoryBudget::MemoryBudget(const Config& cfg) : envs_root(cfg.envs_root) {
+    const char* mb = std::getenv("SPIP_MATRIX_MEM_MB"); long avail = mem_available_kb();
+    budget_kb = mb ? std::atol(mb) * 1024 : (avail > 0 ? avail / 10 * 8 : 0);
+    const char* cell = std::getenv("SPIP_MATRIX_CELL_MB"); default_cell_kb = (cell ? std::atol(cell) : 512) * 1024;
+    const char* psi = std::getenv("SPIP_MATRIX_MEM_PSI"); psi_limit = psi ? std::atof(psi) : 10.0;
+#ifdef __linux__
+    struct statfs sf; on_tmpfs = statfs(envs_root.c_str(), &sf) == 0 && sf.f_type == TMPFS_MAGIC;
+#endif
+}
+
+bool MemoryBudget::fits(long mem_kb, uintmax_t disk_bytes) {
+    if (running == 0) return true;
+    if (reserved_kb + mem_kb > budget_kb) return false;
+    if (long avail = mem_available_kb(); avail >= 0 && avail < mem_kb) return false;
+    if (psi_limit > 0 && memory_pressure_avg10() > psi_limit) return false;
+    struct statvfs vf;
+    if (on_tmpfs && statvfs(envs_root.c_str(), &vf) == 0 && (uintmax_t)vf.f_bavail * vf.f_frsize < reserved_disk + disk_bytes) return false;
+    return true;
+}
+
+long MemoryBudget::admit(long predicted_kb, uintmax_t disk_bytes) {
+    long kb = predicted_kb > 0 ? predicted_kb : default_cell_kb;
+    std::unique_lock<std::mutex> l(m);
+    // Host memory and pressure change without anyone releasing, so re-check every second.
+    while (!g_interrupted && !fits(kb, disk_bytes)) {
+        if (!announced) { announced = true; std::cout << YELLOW << std::format("🧠 Memory budget reached ({} MB reserved of {} MB): holding cells back", reserved_kb / 1024, budget_kb / 1024) << RESET << std::endl; }
+        freed.wait_for(l, std::chrono::seconds(1));
+    }
+    if (g_interrupted) return 0;
+    reserved_kb += kb; reserved_disk += disk_bytes; ++running;
+    return kb;
+}
+
+long MemoryBudget::try_admit(long predicted_kb, uintmax_t disk_bytes) {
+    long kb = predicted_kb > 0 ? predicted_kb : default_cell_kb;
+    std::lock_guard<std::mutex> l(m);
+    if (!fits(kb, disk_bytes)) return 0;
+    reserved_kb += kb; reserved_disk += disk_bytes; ++running;
+    return kb;
+}
+
+void MemoryBudget::release(long kb, uintmax_t disk_bytes) {
+    { std::lock_guard<std::mutex> l(m); reserved_kb -= kb; reserved_disk -= std::min(reserved_disk, disk_bytes); --running; }
+    freed.notify_all();
+}
+
+void MemoryBudget::installed(uintmax_t disk_bytes) {
+    { std::lock_guard<std::mutex> l(m); reserved_disk -= std::min(reserved_disk, disk_bytes); }
+    freed.notify_all();
+}
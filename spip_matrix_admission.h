@@ -0,0 +1,33 @@
+#pragma once
+#include "spip_utils.h"
+#include <condition_variable>
+
+// Admission control for matrix cells. A cell is let into the setup stage only when its predicted
+// peak memory fits in what is left of the run's budget (SPIP_MATRIX_MEM_MB, default 80% of
+// MemAvailable at start; 0 disables), the host still has that much available right now, memory
+// pressure (PSI some avg10) is below SPIP_MATRIX_MEM_PSI (default 10%), and, when envs live on a
+// tmpfs, the mount has room for the unpacked closure on top of what admitted cells may still
+// write. A cell that runs alone is always admitted, so an oversized prediction cannot stall a run.
+class MemoryBudget {
+    std::mutex m;
+    std::condition_variable freed;
+    long budget_kb = 0, reserved_kb = 0, default_cell_kb;
+    uintmax_t reserved_disk = 0;
+    int running = 0;
+    double psi_limit;
+    fs::path envs_root;
+    bool on_tmpfs = false, announced = false;
+    bool fits(long mem_kb, uintmax_t disk_bytes);
+public:
+    explicit MemoryBudget(const Config& cfg);
+    bool enabled() const { return budget_kb > 0; }
+    // Blocks until the cell fits; returns the reservation to hand back to release(), or 0 after Ctrl-C.
+    long admit(long predicted_kb, uintmax_t disk_bytes);
+    long try_admit(long predicted_kb, uintmax_t disk_bytes);   // same, but returns 0 at once when the cell does not fit
+    void release(long kb, uintmax_t disk_bytes);
+    void installed(uintmax_t disk_bytes);   // the closure is on disk now, so statvfs already counts it
+};
+
+long mem_available_kb();
+uintmax_t unpacked_bytes(const Config& cfg, const std::map<std::string, PackageInfo>& closure);   // env space the closure's wheels take once installed
+double memory_pressure_avg10();
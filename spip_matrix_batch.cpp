@@ -0,0 +1,22 @@
+#include "spip_matrix_pipeline.h"
+
+// `spip matrix --packages list.txt` plans every package's cells up front and feeds them all into
+// one pipeline. Resolution shares a ResolveMemo, so a dependency common to many packages is looked
+// up once per Python; downloads already meet in the wheel cache; one worktree pool serves every
+// package, so base envs are bootstrapped once; and the longest cells of any package start first.
+void MatrixTester::run_batch(const Config& cfg, const std::vector<std::string>& packages, const std::string& custom_test_script, const std::string& pv, bool prof, bool nc, int revision_limit, bool test_all_revisions) {
+    std::vector<std::unique_ptr<MatrixTester>> testers; std::vector<CellPtr> cells; int known = 0;
+    for (const auto& p : packages) {
+        auto t = std::make_unique<MatrixTester>(cfg, p);
+        auto versions = t->select_versions(false, revision_limit, test_all_revisions, 1, "");
+        if (versions.empty()) { std::cerr << YELLOW << "⚠️ No versions found for " << p << ", skipping." << RESET << std::endl; continue; }
+        for (auto& c : t->make_cells(versions, t->prepare_test_script(custom_test_script), pv, false)) cells.push_back(std::move(c));
+        known += t->history_cells; testers.push_back(std::move(t));
+    }
+    if (cells.empty()) return;
+    size_t n = cells.size();
+    std::cout << CYAN << std::format("📦 Batch: {} cells across {} packages in one pipeline", n, testers.size()) << RESET << std::endl;
+    auto [predicted, actual] = run_pipeline(cfg, std::move(cells), prof, nc);
+    for (auto& t : testers) t->summarize(prof);
+    std::cout << std::format("⏱  Batch makespan: predicted {:.1f}s, actual {:.1f}s ({}/{} cells had history)", predicted, actual, known, n) << std::endl;
+}
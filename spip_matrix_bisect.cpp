@@ -0,0 +1,47 @@
+#include "spip_matrix_tester.h"
+#include "spip_db.h"
+
+// `spip matrix <pkg> --bisect good..bad` searches the versions between a known good and a known
+// bad one for the first failure. Each round probes k evenly spaced candidates at once (k = worker
+// slots) through the normal pipeline, which cuts the range to 1/(k+1) per round: 300 releases on
+// 8 slots take 3 rounds. With --vary-python the candidates are Python versions instead, each run
+// against the latest package release. A cell passes when it installs and the test script passes.
+
+std::vector<std::string> MatrixTester::bisect_candidates(const std::string& range, bool vary_python) {
+    size_t dots = range.find("..");
+    std::vector<std::string> all = vary_python ? std::vector<std::string>{"2.7", "3.7", "3.8", "3.9", "3.10", "3.11", "3.12", "3.13"} : get_all_versions(pkg);
+    auto good = std::find(all.begin(), all.end(), dots == std::string::npos ? "" : range.substr(0, dots));
+    auto bad = std::find(all.begin(), all.end(), dots == std::string::npos ? "" : range.substr(dots + 2));
+    if (good == all.end() || bad == all.end() || good >= bad) {
+        std::cerr << RED << "❌ --bisect expects good..bad, two known " << (vary_python ? "Python" : pkg) << " versions with good older than bad" << RESET << "\n";
+        return {};
+    }
+    std::vector<std::string> c(good, bad + 1);
+    if (vary_python) { auto pv = get_all_versions(pkg); for (auto& v : c) v += ":" + (pv.empty() ? std::string() : pv.back()); }
+    return c;
+}
+
+void MatrixTester::bisect(const std::vector<std::string>& c, const fs::path& ts, const std::string& pv, bool prof, bool nc, bool vp) {
+    size_t lo = 0, hi = c.size() - 1; int rounds = 0, known = 0, stalled = 0; double predicted = 0, actual = 0;
+    while (hi - lo > 1 && !g_interrupted && stalled < 2) {
+        size_t k = std::min<size_t>(std::max(1, cfg.concurrency), hi - lo - 1);
+        std::vector<size_t> probes; std::vector<std::string> to_do; std::string names;
+        for (size_t i = 1; i <= k; ++i) { probes.push_back(lo + (hi - lo) * i / (k + 1)); to_do.push_back(c[probes.back()]); names += (names.empty() ? "" : ", ") + to_do.back(); }
+        std::cout << CYAN << std::format("🔎 Round {}: {} candidates between {} and {}, testing {}", ++rounds, hi - lo - 1, c[lo], c[hi], names) << RESET << std::endl;
+        size_t first = results.size();
+        parallel_execution(to_do, ts, pv, prof, nc, vp);
+        predicted += predicted_makespan; actual += actual_makespan; known += history_cells;
+        if (g_interrupted) break;
+        // A probe without a verdict (skipped by --deadline, timed out) says nothing about its version.
+        std::map<std::string, bool> ok; for (size_t i = first; i < results.size(); ++i) if (!results[i].timed_out) ok[results[i].version] = results[i].install && results[i].custom_test;
+        // Probes are in version order: everything up to the first failure passed, so the range shrinks to that gap.
+        size_t was_lo = lo, was_hi = hi;
+        for (size_t p : probes) { auto it = ok.find(c[p]); if (it == ok.end()) continue; if (it->second) lo = p; else { hi = p; break; } }
+        if (lo != was_lo || hi != was_hi) stalled = 0;
+        else if (++stalled < 2) std::cout << YELLOW << "⚠️  No probe of this round produced a result; probing again" << RESET << std::endl;
+    }
+    predicted_makespan = predicted; actual_makespan = actual; history_cells = known;
+    summarize(prof);
+    if (g_interrupted || hi - lo > 1) { std::cout << YELLOW << std::format("⚠️  Bisection {}: first failure lies after {} and at or before {}", g_interrupted ? "interrupted" : "stalled", c[lo], c[hi]) << RESET << std::endl; return; }
+    std::cout << GREEN << BOLD << std::format("🎯 First failing {}: {} (last good: {}) after {} rounds, {} cells", vp ? "Python" : "version", c[hi], c[lo], rounds, results.size()) << RESET << std::endl;
+}
@@ -0,0 +1,79 @@
+#include "spip_matrix_tester.h"
+#include "spip_env.h"
+
+// Finished cells are stored in ~/.spip/matrix_results.db under a key covering everything that
+// can change their outcome: package and Python version, the exact base env commit, the resolved
+// dependency closure, the test script and the spip binary itself. A rerun only executes cells
+// whose key moved, and a run stopped by Ctrl-C resumes because each cell is stored as it ends.
+
+static sqlite3* open_results(const Config& cfg) {
+    fs::path p = cfg.spip_root / "matrix_results.db";
+    sqlite3* db; if (sqlite3_open(p.c_str(), &db) != SQLITE_OK) { sqlite3_close(db); return nullptr; }
+    sqlite3_busy_timeout(db, 10000);
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS results (key TEXT PRIMARY KEY, package TEXT, version TEXT, python TEXT, install INTEGER, pkg_tests INTEGER, custom_test INTEGER, "
+                     "wall REAL, cpu REAL, peak_kb INTEGER, recorded_at INTEGER);", nullptr, nullptr, nullptr);
+    return db;
+}
+
+static std::string spip_build_id() {
+    static const std::string id = [] {
+        std::error_code ec; fs::path exe = fs::read_symlink("/proc/self/exe", ec); if (ec) return std::string("unknown");
+        auto size = fs::file_size(exe, ec); auto mtime = fs::last_write_time(exe, ec).time_since_epoch().count();
+        return std::format("{}:{}", size, mtime);
+    }();
+    return id;
+}
+
+std::string matrix_cell_key(const Config& cfg, const std::string& pkg, const std::string& pkg_ver, const std::string& py_ver,
+                            const std::map<std::string, PackageInfo>& closure, const std::string& script_hash) {
+    std::string k = std::format("{}|{}|{}|{}|{}|{}|", pkg, pkg_ver, py_ver, resolve_ref(cfg.repo_path, "base/" + py_ver), script_hash, spip_build_id());
+    for (const auto& [id, info] : closure) k += info.name + "=" + info.version + "@" + (info.sha256.empty() ? info.wheel_url : info.sha256) + ";";
+    return compute_hash(k);
+}
+
+bool load_cached_result(const Config& cfg, const std::string& key, MatrixResult& out) {
+    sqlite3* db = open_results(cfg); if (!db) return false;
+    sqlite3_stmt* stmt; bool hit = false;
+    if (sqlite3_prepare_v2(db, "SELECT install, pkg_tests, custom_test, wall, cpu, peak_kb FROM results WHERE key = ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            out.install = sqlite3_column_int(stmt, 0); out.pkg_tests = sqlite3_column_int(stmt, 1); out.custom_test = sqlite3_column_int(stmt, 2);
+            out.stats.wall_time_seconds = sqlite3_column_double(stmt, 3); out.stats.cpu_time_seconds = sqlite3_column_double(stmt, 4); out.stats.peak_memory_kb = sqlite3_column_int64(stmt, 5);
+            hit = true;
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return hit;
+}
+
+void store_cached_result(const Config& cfg, const std::string& key, const std::string& pkg, const std::string& pkg_ver, const std::string& py_ver, const MatrixResult& r) {
+    static std::mutex m; std::lock_guard<std::mutex> l(m);
+    sqlite3* db = open_results(cfg); if (!db) return;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO results VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 2, pkg.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, pkg_ver.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 4, py_ver.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 5, r.install); sqlite3_bind_int(stmt, 6, r.pkg_tests); sqlite3_bind_int(stmt, 7, r.custom_test);
+        sqlite3_bind_double(stmt, 8, r.stats.wall_time_seconds); sqlite3_bind_double(stmt, 9, r.stats.cpu_time_seconds); sqlite3_bind_int64(stmt, 10, r.stats.peak_memory_kb);
+        sqlite3_bind_int64(stmt, 11, std::time(nullptr));
+        sqlite3_step(stmt); sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+}
+
+std::map<std::pair<std::string, std::string>, MatrixResult> last_outcomes(const Config& cfg, const std::string& pkg) {
+    std::map<std::pair<std::string, std::string>, MatrixResult> out;
+    sqlite3* db = open_results(cfg); if (!db) return out;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT version, python, install, pkg_tests, custom_test FROM results WHERE package = ? ORDER BY recorded_at;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, pkg.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            MatrixResult& r = out[{(const char*)sqlite3_column_text(stmt, 0), (const char*)sqlite3_column_text(stmt, 1)}];   // oldest first: the newest row wins
+            r.version = (const char*)sqlite3_column_text(stmt, 0); r.install = sqlite3_column_int(stmt, 2); r.pkg_tests = sqlite3_column_int(stmt, 3); r.custom_test = sqlite3_column_int(stmt, 4);
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return out;
+}
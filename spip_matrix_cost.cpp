@@ -0,0 +1,75 @@
+#include "spip_matrix_cost.h"
+
+static sqlite3* open_history(const Config& cfg) {
+    fs::path p = cfg.spip_root / "matrix_history.db";
+    std::error_code ec; fs::create_directories(p.parent_path(), ec);
+    sqlite3* db; if (sqlite3_open(p.c_str(), &db) != SQLITE_OK) { sqlite3_close(db); return nullptr; }
+    sqlite3_busy_timeout(db, 10000);
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS cells (package TEXT, version TEXT, python TEXT, wall REAL, cpu REAL, peak_kb INTEGER, install_ok INTEGER, recorded_at INTEGER);"
+                     "CREATE INDEX IF NOT EXISTS idx_cells_pkg ON cells(package);", nullptr, nullptr, nullptr);
+    return db;
+}
+
+static double median(std::vector<double> v) {
+    if (v.empty()) return 0;
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    return v[v.size() / 2];
+}
+
+CellCostModel::CellCostModel(const Config& cfg, const std::string& p) : pkg(p) {
+    sqlite3* db = open_history(cfg); if (!db) return;
+    sqlite3_stmt* stmt; std::vector<double> all, mine, mine_peaks; std::map<std::string, std::vector<double>> by_python;
+    if (sqlite3_prepare_v2(db, "SELECT package, version, python, wall, peak_kb FROM cells ORDER BY recorded_at DESC LIMIT 20000;", -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            std::string pk = (const char*)sqlite3_column_text(stmt, 0); double wall = sqlite3_column_double(stmt, 3);
+            all.push_back(wall); if (pk != pkg) continue;
+            std::string ver = (const char*)sqlite3_column_text(stmt, 1), py = (const char*)sqlite3_column_text(stmt, 2);
+            auto& w = walls[{ver, py}]; bool recent = w.size() < 5; if (recent) w.push_back(wall);   // newest first: keep the last five runs
+            if (long kb = sqlite3_column_int64(stmt, 4); kb > 0) { if (recent) peaks[{ver, py}] = std::max(peaks[{ver, py}], kb); mine_peaks.push_back(kb); }
+            mine.push_back(wall); by_python[py].push_back(wall);
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    global_median = median(all); pkg_median = median(mine);
+    // Memory is admitted by peak, so the package fallback leans high: its 90th percentile.
+    if (!mine_peaks.empty()) { std::sort(mine_peaks.begin(), mine_peaks.end()); pkg_peak_kb = (long)mine_peaks[mine_peaks.size() * 9 / 10]; }
+    for (const auto& [py, v] : by_python) python_median[py] = median(v);
+}
+
+double CellCostModel::predict(const std::string& version, const std::string& python, bool* known) const {
+    if (known) *known = false;
+    if (auto it = walls.find({version, python}); it != walls.end()) {
+        if (known) *known = true;
+        return median(it->second);
+    }
+    if (auto it = python_median.find(python); it != python_median.end()) return it->second;
+    if (pkg_median > 0) return pkg_median;
+    return global_median > 0 ? global_median : 1.0;
+}
+
+long CellCostModel::predict_peak_kb(const std::string& version, const std::string& python) const {
+    if (auto it = peaks.find({version, python}); it != peaks.end()) return it->second;
+    return pkg_peak_kb;
+}
+
+void CellCostModel::record(const Config& cfg, const std::string& pkg, const std::string& version, const std::string& python, const ResourceUsage& u, bool install_ok) {
+    static std::mutex m; std::lock_guard<std::mutex> l(m);
+    sqlite3* db = open_history(cfg); if (!db) return;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "INSERT INTO cells VALUES (?, ?, ?, ?, ?, ?, ?, ?);", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, pkg.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 2, version.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, python.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_double(stmt, 4, u.wall_time_seconds);
+        sqlite3_bind_double(stmt, 5, u.cpu_time_seconds); sqlite3_bind_int64(stmt, 6, u.peak_memory_kb);
+        sqlite3_bind_int(stmt, 7, install_ok ? 1 : 0); sqlite3_bind_int64(stmt, 8, std::time(nullptr));
+        sqlite3_step(stmt); sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+}
+
+double predict_makespan(std::vector<double> costs, int workers) {
+    std::sort(costs.rbegin(), costs.rend());
+    std::vector<double> load(std::max(1, workers), 0.0);
+    for (double c : costs) *std::min_element(load.begin(), load.end()) += c;
+    return *std::max_element(load.begin(), load.end());
+}
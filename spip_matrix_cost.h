@@ -0,0 +1,22 @@
+#pragma once
+#include "spip_utils.h"
+
+// Predicted cost of a matrix cell (seconds spent installing, testing and resetting its env),
+// learned from earlier runs recorded in ~/.spip/matrix_history.db. Unknown cells borrow from the closest history: the same
+// package on that Python, then the package overall, then every package spip has measured.
+class CellCostModel {
+    std::string pkg;
+    std::map<std::pair<std::string, std::string>, std::vector<double>> walls;   // (version, python) -> recent walls
+    double pkg_median = 0, global_median = 0;
+    std::map<std::string, double> python_median;
+    std::map<std::pair<std::string, std::string>, long> peaks;   // (version, python) -> largest recent peak RSS
+    long pkg_peak_kb = 0;
+public:
+    CellCostModel(const Config& cfg, const std::string& pkg);
+    double predict(const std::string& version, const std::string& python, bool* known = nullptr) const;
+    long predict_peak_kb(const std::string& version, const std::string& python) const;   // 0: no history
+    static void record(const Config& cfg, const std::string& pkg, const std::string& version, const std::string& python, const ResourceUsage& u, bool install_ok);
+};
+
+// Longest-processing-time list schedule of `costs` on `workers` machines.
+double predict_makespan(std::vector<double> costs, int workers);
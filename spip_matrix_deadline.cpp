@@ -0,0 +1,48 @@
+#include "spip_matrix_deadline.h"
+#include "spip_matrix_cost.h"
+
+static double seconds_left(std::chrono::steady_clock::time_point end) { return std::chrono::duration<double>(end - std::chrono::steady_clock::now()).count(); }
+
+std::vector<CellPtr> plan_for_deadline(std::vector<CellPtr> cells, std::chrono::steady_clock::time_point deadline, int workers) {
+    double left = seconds_left(deadline); size_t n = cells.size();
+    std::stable_sort(cells.begin(), cells.end(), [](const CellPtr& a, const CellPtr& b) { return a->value / a->predicted > b->value / b->predicted; });
+    std::vector<CellPtr> planned, standby; std::vector<double> costs;
+    for (auto& c : cells) {
+        costs.push_back(c->predicted);
+        if (predict_makespan(costs, workers) <= left) planned.push_back(std::move(c));
+        else { costs.pop_back(); standby.push_back(std::move(c)); }
+    }
+    double makespan = predict_makespan(costs, workers);
+    std::stable_sort(planned.begin(), planned.end(), [](const CellPtr& a, const CellPtr& b) { return a->value > b->value; });
+    std::cout << CYAN << std::format("⏳ Deadline in {:.0f}s: planned {}/{} cells (predicted makespan {:.1f}s), {} on standby", left, planned.size(), n, makespan, standby.size()) << RESET << std::endl;
+    for (auto& c : standby) planned.push_back(std::move(c));
+    return planned;
+}
+
+// Observed/predicted time of finished cells, damped to [0.25, 4] so one outlier cannot swing the plan.
+double DeadlineGate::scale() const { return predicted_done > 0 ? std::clamp(actual_done / predicted_done, 0.25, 4.0) : 1.0; }
+
+// Cells actually busy at once so far: the planner's worker count overstates it whenever stages
+// wait on each other or the host is short of cores.
+double DeadlineGate::parallelism() const {
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return actual_done > 0 && elapsed > 0 ? std::clamp(actual_done / elapsed, 1.0, (double)workers) : workers;
+}
+
+// The cell starts once the work already admitted drains from the workers, then runs its own time.
+bool DeadlineGate::fits(double predicted) const { return (committed / parallelism() + predicted) * scale() <= seconds_left(end); }
+
+bool DeadlineGate::could_fit(double predicted) { std::lock_guard<std::mutex> l(m); return predicted * scale() <= seconds_left(end); }
+
+bool DeadlineGate::admit(double predicted) {
+    std::lock_guard<std::mutex> l(m);
+    if (!fits(predicted)) return false;
+    committed += predicted; return true;
+}
+
+void DeadlineGate::finish(double predicted, double actual) {
+    std::lock_guard<std::mutex> l(m);
+    committed = std::max(0.0, committed - predicted); predicted_done += predicted; actual_done += actual;
+}
+
+void DeadlineGate::withdraw(double predicted) { std::lock_guard<std::mutex> l(m); committed = std::max(0.0, committed - predicted); }
@@ -0,0 +1,28 @@
+#pragma once
+#include "spip_matrix_pipeline.h"
+
+// Deadline-aware planning (`spip matrix --deadline 20m`). Every cell gets a coverage value: one
+// for running at all, up to one more the newer its package version, two if its last recorded
+// result failed and one if it has never been measured. plan_for_deadline picks the cells with
+// the best value per predicted second while the predicted makespan stays inside the time left,
+// queues them by value, and keeps the rest as standby behind them. During the run DeadlineGate
+// rescales predictions by how fast finished cells really were and how many ran side by side, so
+// a slow run sheds low-value cells and a fast one picks up standby cells, both at the moment a
+// cell would take a worktree.
+std::vector<CellPtr> plan_for_deadline(std::vector<CellPtr> cells, std::chrono::steady_clock::time_point deadline, int workers);
+
+class DeadlineGate {
+    std::mutex m;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(), end;
+    int workers;
+    double committed = 0, predicted_done = 0, actual_done = 0;   // seconds of predicted work in flight / finished
+    double scale() const;
+    double parallelism() const;
+    bool fits(double predicted) const;
+public:
+    DeadlineGate(std::chrono::steady_clock::time_point deadline, int w) : end(deadline), workers(std::max(1, w)) {}
+    bool could_fit(double predicted);   // cheap early check: would the cell finish even on an idle worker?
+    bool admit(double predicted);       // reserves the cell's predicted time when it fits
+    void finish(double predicted, double actual);
+    void withdraw(double predicted);    // an admitted cell that never ran
+};
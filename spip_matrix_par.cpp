@@ -1,82 +1,191 @@
-#include "spip_matrix_tester.h"
+#include "spip_matrix_pipeline.h"
 #include "spip_env.h"
 #include "spip_install.h"
 #include "spip_test.h"
+#include "spip_matrix_pool.h"
+#include "spip_matrix_cost.h"
+#include "spip_matrix_admission.h"
+#include "spip_matrix_deadline.h"
+#include "spip_matrix_straggler.h"
+#include <optional>
 
-void MatrixTester::parallel_execution(const std::vector<std::string>& to_do, const fs::path& ts, const std::string& pv, bool prof, bool nc, bool vp) {
-    unsigned int nt = cfg.concurrency ? cfg.concurrency : 4;
-    std::atomic<size_t> idx{0};
-    std::mutex m_res;
-    std::vector<std::thread> ws;
+// One cell flows resolve -> download -> setup -> install -> test -> cleanup, each stage with its
+// own workers and a bounded queue in front of the next, so the first cell is under test while
+// later ones are still resolving or downloading. A cell that fails (or arrives after Ctrl-C)
+// skips the remaining work but still reaches cleanup, which returns its worktree to the pool.
+// Cells enter longest-predicted-first and every stage queue balances by predicted cost, so the
+// slow cells are never the ones left to start at the end. A cell whose key (version, Python, base
+// commit, resolved closure, test script, spip build) already has a stored result skips straight
+// to cleanup with it; every finished cell is stored, so an interrupted run resumes where it stopped.
+// On multi-node hosts the install, test and cleanup workers pin themselves to the cell's slot
+// (spip_numa.h) for the duration of that cell, so its processes and env memory share a node.
+// Hung or slow cells are handled by StragglerWatch (spip_matrix_straggler.h).
 
-    auto wt = [&]() {
-        while(!g_interrupted) {
-            size_t ti = idx.fetch_add(1);
-            if(ti >= to_do.size()) break;
-            const auto& ver = to_do[ti];
-            
-            // 1. Setup isolated environment
-            Config tcfg = cfg;
-            std::string resolved_pv = (pv == "auto") ? "3.12" : pv;
-            std::string py_ver = vp ? (ver.find(':') != std::string::npos ? split(ver, ':')[0] : resolved_pv) : resolved_pv;
-            std::string pkg_ver = vp ? (ver.find(':') != std::string::npos ? split(ver, ':')[1] : ver) : ver;
-            
-            // Unique path per task to avoid collisions
-            tcfg.project_env_path = cfg.envs_root / ("mat_" + pkg + "_" + pkg_ver + "_" + std::to_string(ti));
-            
-            // Use a unique branch name for worktree
-            tcfg.project_hash += "_" + std::to_string(ti); 
-            
-            setup_project_env(tcfg, py_ver);
+static void add_usage(ResourceUsage& total, const ResourceUsage& u) {
+    total.cpu_time_seconds += u.cpu_time_seconds; total.peak_memory_kb = std::max(total.peak_memory_kb, u.peak_memory_kb);
+    total.disk_delta_bytes += u.disk_delta_bytes; total.io_read_bytes += u.io_read_bytes; total.io_write_bytes += u.io_write_bytes;
+    total.cpu_pressure_seconds += u.cpu_pressure_seconds; total.memory_pressure_seconds += u.memory_pressure_seconds; total.io_pressure_seconds += u.io_pressure_seconds;
+}
 
-            // 2. Install
-            ResourceUsage stats = {};
-            std::unique_ptr<ResourceProfiler> profiler;
-            if (prof) profiler = std::make_unique<ResourceProfiler>(tcfg.project_env_path);
-            
-            bool install_ok = resolve_and_install(tcfg, {pkg}, pkg_ver, py_ver);
-            
-            // 3. Tests
-            bool pkg_ok = false;
-            bool custom_ok = false;
-            
-            if (install_ok) {
-                // Inline package test logic to capture result
-                const fs::path sp = get_site_packages(tcfg);
-                if (!sp.empty()) {
-                   fs::path bin = tcfg.project_env_path / "bin" / "python";
-                   std::string check = std::format("{} -c \"import {}; print('OK')\"", quote_arg(bin.string()), pkg);
-                   if (run_shell(check.c_str()) == 0) {
-                        std::string test_cmd = std::format("{} -m pytest {}", quote_arg(bin.string()), quote_arg(sp.string()));
-                        pkg_ok = (run_shell(test_cmd.c_str()) == 0);
-                   }
-                }
-                
-                if (!ts.empty()) {
-                    std::string cmd = std::format("{} {}", quote_arg(tcfg.project_env_path / "bin" / "python"), quote_arg(ts.string()));
-                    custom_ok = (run_shell(cmd.c_str()) == 0);
-                }
-            }
-            
-            if (profiler) stats = profiler->stop();
-            
-            // 4. Cleanup
-            if (!nc) {
-                // Detach worktree
-                run_shell(std::format("cd {} && git worktree remove --force {}", quote_arg(cfg.repo_path.string()), quote_arg(tcfg.project_env_path.string())).c_str());
-                run_shell(std::format("rm -rf {}", quote_arg(tcfg.project_env_path.string())).c_str());
-            }
+// Collects the peak RSS of a stage's children when --profile is off, so history (and with it
+// memory admission) always knows how big a cell gets.
+struct PeakScope {
+    ProcAccount account; ProcAccount* outer = t_proc_account;
+    PeakScope() { t_proc_account = &account; }
+    ~PeakScope() { t_proc_account = outer; }
+};
+
+// Wraps a stage body so its run time counts towards the cell's busy time.
+template <typename F>
+static auto timed(F work) {
+    return [work](MatrixCell& c) { auto t0 = std::chrono::steady_clock::now(); work(c); c.busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+}
+
+template <typename F>
+static std::vector<std::thread> run_stage(int workers, StageQueue<CellPtr>& in, StageQueue<CellPtr>* out, F work) {
+    auto remaining = std::make_shared<std::atomic<int>>(workers);
+    std::vector<std::thread> ts;
+    for (int i = 0; i < workers; ++i) ts.emplace_back([&in, out, work, remaining, i] {
+        CellPtr cell;
+        while (in.pop(i, cell)) { work(*cell); if (out) { double cost = cell->predicted; out->push(std::move(cell), cost); } }
+        if (--*remaining == 0 && out) out->close();
+    });
+    return ts;
+}
+
+void install_cell(MatrixCell& c, bool prof) {
+    std::unique_ptr<ResourceProfiler> profiler; if (prof) profiler = std::make_unique<ResourceProfiler>(c.tcfg.project_env_path);
+    std::optional<PeakScope> peak; if (!prof) peak.emplace();
+    c.res.install = install_packages(c.tcfg, c.needed);
+    if (profiler) add_usage(c.res.stats, profiler->stop());
+    if (peak) c.res.stats.peak_memory_kb = std::max(c.res.stats.peak_memory_kb, peak->account.usage.peak_rss_kb);
+}
+
+// Each step is skipped once the cell's time is up: what is left would only be killed on arrival.
+void test_cell(MatrixCell& c, bool prof) {
+    std::unique_ptr<ResourceProfiler> profiler; if (prof) profiler = std::make_unique<ResourceProfiler>();
+    std::optional<PeakScope> peak; if (!prof) peak.emplace();
+    const fs::path sp = get_site_packages(c.tcfg);
+    if (!sp.empty() && run_env_python(c.tcfg, {"-c", std::format("import {}; print('OK')", c.pkg)}).status == 0 && !c.limit.expired())
+        c.res.pkg_tests = (run_env_python(c.tcfg, {"-m", "pytest", sp.string()}).status == 0);
+    if (!c.test_script.empty() && !c.limit.expired()) c.res.custom_test = (run_env_python(c.tcfg, {c.test_script.string()}).status == 0);
+    if (profiler) add_usage(c.res.stats, profiler->stop());
+    if (peak) c.res.stats.peak_memory_kb = std::max(c.res.stats.peak_memory_kb, peak->account.usage.peak_rss_kb);
+}
 
-            // 5. Record
-            {
-                std::lock_guard<std::mutex> l(m_res);
-                results.push_back({ver, install_ok, pkg_ok, custom_ok, stats});
-                std::cout << "." << std::flush;
+std::vector<CellPtr> MatrixTester::make_cells(const std::vector<std::string>& to_do, const fs::path& ts, const std::string& pv, bool vp) {
+    std::string resolved_pv = (pv == "auto") ? "3.12" : pv, script_hash = ts.empty() ? "" : compute_file_sha256(ts);
+    CellCostModel model(cfg, pkg); std::vector<CellPtr> cells; history_cells = 0;
+    bool deadline = cfg.matrix_deadline != std::chrono::steady_clock::time_point{};
+    auto outcomes = deadline ? last_outcomes(cfg, pkg) : std::map<std::pair<std::string, std::string>, MatrixResult>{};
+    std::vector<std::string> pkg_vers;   // first-seen order, oldest to newest like get_all_versions
+    for (const auto& ver : to_do) {
+        auto cell = std::make_unique<MatrixCell>(); cell->owner = this; cell->pkg = pkg; cell->ver = ver; cell->test_script = ts; cell->script_hash = script_hash;
+        cell->py_ver = vp ? (ver.find(':') != std::string::npos ? split(ver, ':')[0] : resolved_pv) : resolved_pv;
+        cell->pkg_ver = vp ? (ver.find(':') != std::string::npos ? split(ver, ':')[1] : ver) : ver;
+        if (auto parts = split(ver, ':'); vp && parts.size() > 2) for (const auto& kv : split(parts[2], ',')) if (size_t eq = kv.find('='); eq != std::string::npos) cell->pins[kv.substr(0, eq)] = kv.substr(eq + 1);
+        cell->res.version = ver;
+        bool k = false; cell->predicted = model.predict(cell->pkg_ver, cell->py_ver, &k); history_cells += k;
+        cell->peak_kb = model.predict_peak_kb(cell->pkg_ver, cell->py_ver);
+        if (auto it = outcomes.find({cell->pkg_ver, cell->py_ver}); it != outcomes.end() && (!it->second.install || (!ts.empty() && !it->second.custom_test))) cell->value += 2;
+        if (!k) cell->value += 1;
+        if (std::find(pkg_vers.begin(), pkg_vers.end(), cell->pkg_ver) == pkg_vers.end()) pkg_vers.push_back(cell->pkg_ver);
+        cells.push_back(std::move(cell));
+    }
+    for (auto& c : cells) c->value += 1.0 / (pkg_vers.end() - std::find(pkg_vers.begin(), pkg_vers.end(), c->pkg_ver));   // newest: +1, next: +1/2, ...
+    return cells;
+}
+
+std::pair<double, double> MatrixTester::run_pipeline(const Config& cfg, std::vector<CellPtr> cells, bool prof, bool nc) {
+    StageLimits lim = StageLimits::from_config(cfg);
+    CpuPlacement placement = CpuPlacement::for_host(cfg);
+    WorktreePool pool(cfg, &placement);
+    MemoryBudget budget(cfg);
+    ResolveMemo memo;   // one lookup per (package, version, Python) across all cells, whichever package they test
+    std::mutex m_res;
+    StageQueue<CellPtr> q_resolve(lim.resolve, cells.size()), q_download(lim.download, 2 * lim.download), q_setup(lim.setup, lim.setup),
+                        q_install(lim.install, lim.install), q_test(lim.test, lim.test), q_cleanup(lim.cleanup, 2 * lim.cleanup);
+    std::vector<double> costs; for (const auto& cell : cells) costs.push_back(cell->predicted);
+    std::optional<DeadlineGate> gate;
+    if (cfg.matrix_deadline != std::chrono::steady_clock::time_point{}) {
+        cells = plan_for_deadline(std::move(cells), cfg.matrix_deadline, lim.cells()); gate.emplace(cfg.matrix_deadline, lim.cells());
+    } else std::stable_sort(cells.begin(), cells.end(), [](const CellPtr& a, const CellPtr& b) { return a->predicted > b->predicted; });
+    StragglerWatch watch(cfg, pool, placement, budget, gate ? &*gate : nullptr, prof, lim.test);
+    for (auto& cell : cells) { double cost = cell->predicted; q_resolve.push(std::move(cell), cost); }
+    q_resolve.close();
+    double predicted = predict_makespan(costs, lim.cells());
+    auto t_start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> all;
+    auto add = [&](std::vector<std::thread> stage) { for (auto& t : stage) all.push_back(std::move(t)); };
+    add(run_stage(lim.resolve, q_resolve, &q_download, [&](MatrixCell& c) {
+        if (gate && !gate->could_fit(c.predicted)) { c.skipped = true; return; }
+        if (!g_interrupted) c.needed = resolve_only({c.pkg}, c.pkg_ver, c.py_ver, c.pins, &memo);
+        if (cfg.matrix_cache && !c.needed.empty()) c.cached = load_cached_result(cfg, matrix_cell_key(cfg, c.pkg, c.pkg_ver, c.py_ver, c.needed, c.script_hash), c.res);
+    }));
+    add(run_stage(lim.download, q_download, &q_setup, [&](MatrixCell& c) {
+        if (c.cached) return;
+        c.fetched = !c.needed.empty();
+        for (const auto& [id, info] : c.needed) if (g_interrupted || !fetch_wheel(cfg, info)) { c.fetched = false; break; }
+    }));
+    add(run_stage(lim.setup, q_setup, &q_install, [&](MatrixCell& c) {
+        if (!c.fetched || g_interrupted) return;
+        if (gate && !gate->admit(c.predicted)) { c.skipped = true; return; }
+        if (budget.enabled()) {
+            c.disk_bytes = unpacked_bytes(cfg, c.needed);
+            if (!(c.admitted_kb = budget.admit(c.peak_kb, c.disk_bytes))) return;
+        }
+        try { c.tcfg = pool.lease(c.py_ver, &c.slot); c.leased = true; }
+        catch (const std::exception& e) {
+            std::cerr << RED << "❌ No worktree for " << c.pkg << " " << c.ver << ": " << e.what() << RESET << std::endl;
+            if (c.admitted_kb) { budget.release(c.admitted_kb, c.disk_bytes); c.admitted_kb = 0; }
+            if (gate) gate->withdraw(c.predicted);
+            return;
+        }
+        c.started = std::chrono::steady_clock::now();   // after the lease: a first-time base bootstrap is not this cell's cost
+    }));
+    add(run_stage(lim.install, q_install, &q_test, timed([&](MatrixCell& c) {
+        if (!c.leased || g_interrupted) return;
+        watch.begin(c);
+        SlotPin pin(&placement, c.slot); DeadlineScope scope(c.limit);
+        install_cell(c, prof);
+        if (c.admitted_kb) { budget.installed(c.disk_bytes); c.disk_bytes = 0; }
+    })));
+    add(run_stage(lim.test, q_test, &q_cleanup, timed([&](MatrixCell& c) {
+        if (c.leased && c.res.install && !c.limit.expired() && !g_interrupted) { SlotPin pin(&placement, c.slot); DeadlineScope scope(c.limit); test_cell(c, prof); }
+        if (c.leased) watch.finish(c);
+    })));
+    add(run_stage(lim.cleanup, q_cleanup, nullptr, [&](MatrixCell& c) {
+        // Reset to base unless the user wants to inspect the env
+        if (c.leased) {
+            watch.settle(c);
+            auto t0 = std::chrono::steady_clock::now();
+            SlotPin pin(&placement, c.slot);
+            pool.release(c.tcfg, !nc);
+            if (c.admitted_kb) budget.release(c.admitted_kb, c.disk_bytes);
+            auto now = std::chrono::steady_clock::now();
+            c.res.stats.wall_time_seconds = std::chrono::duration<double>(now - c.started).count();
+            c.busy += std::chrono::duration<double>(now - t0).count();
+            ResourceUsage cost = c.res.stats; cost.wall_time_seconds = c.busy;
+            if (gate) gate->finish(c.predicted, c.busy);
+            // A timed-out cell cost at least the timeout, which history keeps so the cell is not planned as
+            // cheap and untested again; its cut-short result stays out of the cache.
+            if (!g_interrupted) {
+                if (c.res.timed_out) cost.wall_time_seconds = std::max(cost.wall_time_seconds, cfg.matrix_cell_timeout);
+                CellCostModel::record(cfg, c.pkg, c.pkg_ver, c.py_ver, cost, c.res.install);
+                if (!c.res.timed_out) store_cached_result(cfg, matrix_cell_key(cfg, c.pkg, c.pkg_ver, c.py_ver, c.needed, c.script_hash), c.pkg, c.pkg_ver, c.py_ver, c.res);
             }
         }
-    };
-    
-    for(unsigned int i=0; i<nt; ++i) ws.emplace_back(wt);
-    for(auto& t : ws) t.join();
+        std::lock_guard<std::mutex> l(m_res);
+        if (c.skipped) c.owner->deadline_skipped.push_back(c.ver);
+        else { c.owner->results.push_back(c.res); c.owner->cached_cells += c.cached; c.owner->speculated_cells += (bool)c.spec; c.owner->speculation_wins += c.spec && c.spec->won; }
+        std::cout << "." << std::flush;
+    }));
+    for (auto& t : all) t.join();
     std::cout << std::endl;
-}
\ No newline at end of file
+    return {predicted, std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count()};
+}
+
+void MatrixTester::parallel_execution(const std::vector<std::string>& to_do, const fs::path& ts, const std::string& pv, bool prof, bool nc, bool vp) {
+    std::tie(predicted_makespan, actual_makespan) = run_pipeline(cfg, make_cells(to_do, ts, pv, vp), prof, nc);
+}
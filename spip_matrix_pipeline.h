@@ -0,0 +1,96 @@
+#pragma once
+#include "spip_matrix_tester.h"
+#include "spip_process.h"
+#include <condition_variable>
+#include <deque>
+
+// Hand-off between matrix stages: one deque per consumer worker plus a bound on the total.
+// push() places an item on the worker with the least predicted work queued and blocks while the
+// stage is full, which keeps a fast upstream stage (resolution) from leasing worktrees or filling
+// disk far ahead of the slow one (tests). A worker takes from the front of its own deque and,
+// when that is empty, steals the front of the most loaded one. close() lets consumers drain what
+// is left and then see the end.
+template <typename T>
+class StageQueue {
+    struct Lane { std::deque<std::pair<T, double>> items; double pending = 0; };
+    std::mutex m;
+    std::condition_variable not_empty, not_full;
+    std::vector<Lane> lanes;
+    size_t cap, size = 0;
+    bool closed = false;
+public:
+    StageQueue(int workers, size_t capacity) : lanes(std::max(1, workers)), cap(std::max<size_t>(1, capacity)) {}
+    void push(T v, double cost = 1) {
+        std::unique_lock<std::mutex> l(m);
+        not_full.wait(l, [&] { return size < cap || closed; });
+        Lane& to = *std::min_element(lanes.begin(), lanes.end(), [](const Lane& a, const Lane& b) { return a.pending < b.pending; });
+        to.items.emplace_back(std::move(v), cost); to.pending += cost; ++size;
+        not_empty.notify_all();
+    }
+    bool pop(int worker, T& out) {
+        std::unique_lock<std::mutex> l(m);
+        not_empty.wait(l, [&] { return size > 0 || closed; });
+        if (size == 0) return false;
+        Lane* from = &lanes[worker % lanes.size()];
+        if (from->items.empty()) from = &*std::max_element(lanes.begin(), lanes.end(), [](const Lane& a, const Lane& b) { return a.pending < b.pending; });
+        out = std::move(from->items.front().first); from->pending -= from->items.front().second; from->items.pop_front(); --size;
+        not_full.notify_one();
+        return true;
+    }
+    void close() { std::lock_guard<std::mutex> l(m); closed = true; not_empty.notify_all(); not_full.notify_all(); }
+};
+
+// Workers per stage, sized to what each stage waits on: resolution and downloads on the network,
+// env setup, install and cleanup on disk/git, tests on CPU. SPIP_MATRIX_STAGES overrides any of
+// them, e.g. "download:16,test:2".
+struct StageLimits {
+    int resolve, download, setup, install, test, cleanup;
+    static StageLimits from_config(const Config& cfg) {
+        int c = std::max(1, cfg.concurrency);
+        StageLimits s{ 2 * c, c, std::max(1, c / 2), c, c, std::max(1, c / 4) };
+        if (const char* e = std::getenv("SPIP_MATRIX_STAGES")) for (const auto& kv : split(e, ',')) {
+            size_t colon = kv.find(':'); if (colon == std::string::npos) continue;
+            std::string k = kv.substr(0, colon); int n = std::max(1, std::atoi(kv.c_str() + colon + 1));
+            if (k == "resolve") s.resolve = n; else if (k == "download") s.download = n; else if (k == "setup") s.setup = n;
+            else if (k == "install") s.install = n; else if (k == "test") s.test = n; else if (k == "cleanup") s.cleanup = n;
+        }
+        return s;
+    }
+    // Cells in flight at once. Every cell passes through an install worker and then a test worker,
+    // and its predicted cost covers both, so the narrower stage bounds the run.
+    int cells() const { return std::min(install, test); }
+};
+
+// One (package, version, Python) combination on its way through the matrix stages.
+struct MatrixCell {
+    MatrixTester* owner = nullptr;   // collects the result; batch runs mix cells of many testers
+    std::string pkg, ver, py_ver, pkg_ver;
+    fs::path test_script; std::string script_hash;
+    double predicted = 1;
+    double busy = 0;    // seconds spent in install, test and cleanup, queue waits excluded
+    double value = 1;   // coverage worth under --deadline (spip_matrix_deadline.h)
+    long peak_kb = 0, admitted_kb = 0;   // predicted peak RSS (0: no history) and what MemoryBudget reserved
+    uintmax_t disk_bytes = 0;            // reserved env space until the closure is installed
+    std::map<std::string, std::string> pins;   // dependency versions fixed by the planner
+    std::map<std::string, PackageInfo> needed;
+    bool fetched = false, leased = false, cached = false, skipped = false;   // skipped: dropped to meet the deadline
+    int slot = -1;   // pool worktree index; decides the CPUs and NUMA node the cell runs on
+    ProcDeadline limit;   // --cell-timeout, or cancellation once a speculative copy has won
+    std::chrono::steady_clock::time_point running_since;
+    std::shared_ptr<struct Speculation> spec;
+    Config tcfg;
+    std::chrono::steady_clock::time_point started;
+    MatrixResult res{};
+};
+using CellPtr = std::unique_ptr<MatrixCell>;
+
+// Install and test bodies of the pipeline stages (spip_matrix_par.cpp), also run by speculative copies.
+void install_cell(MatrixCell& c, bool prof);
+void test_cell(MatrixCell& c, bool prof);
+
+// Installs a cell's time limit as the calling thread's t_proc_deadline.
+struct DeadlineScope {
+    ProcDeadline* outer = t_proc_deadline;
+    explicit DeadlineScope(ProcDeadline& d) { t_proc_deadline = &d; }
+    ~DeadlineScope() { t_proc_deadline = outer; }
+};
@@ -0,0 +1,108 @@
+#include "spip_matrix_plan.h"
+#include "spip_matrix_tester.h"
+#include "spip_db.h"
+
+// Greedy density construction: each new row starts from one uncovered t-tuple, then fixes the
+// remaining dimensions one at a time to the value consistent with the most uncovered tuples.
+std::vector<std::vector<std::string>> covering_array(const std::vector<std::vector<std::string>>& dims, int t) {
+    size_t n = dims.size(); if (n == 0) return {};
+    for (const auto& d : dims) if (d.empty()) return {};
+    t = std::clamp<int>(t, 1, (int)n);
+    std::vector<std::vector<size_t>> combos; std::vector<size_t> pick;
+    std::function<void(size_t)> gen = [&](size_t from) {
+        if (pick.size() == (size_t)t) { combos.push_back(pick); return; }
+        for (size_t d = from; d < n; ++d) { pick.push_back(d); gen(d + 1); pick.pop_back(); }
+    };
+    gen(0);
+    std::vector<std::set<std::vector<size_t>>> uncovered(combos.size()); size_t left = 0;
+    for (size_t ci = 0; ci < combos.size(); ++ci) {
+        std::vector<size_t> tup(t, 0);
+        while (true) {
+            uncovered[ci].insert(tup); ++left;
+            size_t j = 0; while (j < tup.size() && ++tup[j] == dims[combos[ci][j]].size()) tup[j++] = 0;
+            if (j == tup.size()) break;
+        }
+    }
+    auto consistent = [&](const std::vector<size_t>& combo, const std::vector<size_t>& tup, const std::vector<long>& row) {
+        for (size_t j = 0; j < combo.size(); ++j) if (row[combo[j]] >= 0 && (size_t)row[combo[j]] != tup[j]) return false;
+        return true;
+    };
+    std::vector<std::vector<std::string>> rows;
+    while (left > 0) {
+        std::vector<long> row(n, -1);
+        for (size_t ci = 0; ci < combos.size(); ++ci) if (!uncovered[ci].empty()) {
+            const auto& seed = *uncovered[ci].begin(); for (size_t j = 0; j < seed.size(); ++j) row[combos[ci][j]] = seed[j];
+            break;
+        }
+        for (size_t d = 0; d < n; ++d) if (row[d] < 0) {
+            size_t best = 0, best_gain = 0;
+            for (size_t v = 0; v < dims[d].size(); ++v) {
+                row[d] = v; size_t gain = 0;
+                for (size_t ci = 0; ci < combos.size(); ++ci) if (std::find(combos[ci].begin(), combos[ci].end(), d) != combos[ci].end())
+                    for (const auto& tup : uncovered[ci]) gain += consistent(combos[ci], tup, row);
+                if (gain > best_gain) { best = v; best_gain = gain; }
+            }
+            row[d] = best;
+        }
+        for (size_t ci = 0; ci < combos.size(); ++ci) {
+            std::vector<size_t> tup; for (size_t d : combos[ci]) tup.push_back(row[d]);
+            left -= uncovered[ci].erase(tup);
+        }
+        std::vector<std::string> r; for (size_t d = 0; d < n; ++d) r.push_back(dims[d][row[d]]);
+        rows.push_back(std::move(r));
+    }
+    return rows;
+}
+
+std::vector<std::vector<std::string>> expand_around(const std::vector<std::vector<std::string>>& dims, const std::vector<std::string>& row) {
+    std::vector<std::vector<std::string>> out;
+    for (size_t d = 0; d < dims.size() && d < row.size(); ++d)
+        for (const auto& v : dims[d]) if (v != row[d]) { auto r = row; r[d] = v; out.push_back(std::move(r)); }
+    return out;
+}
+
+// Planned cells are "python:version[:dep=ver,dep=ver]", the vary-python cell format plus pins.
+static std::string plan_cell(const std::vector<std::string>& row) {
+    std::string s = row[0] + ":" + row[1];
+    for (size_t d = 2; d < row.size(); ++d) s += (d == 2 ? ":" : ",") + row[d];
+    return s;
+}
+
+static std::vector<std::string> plan_row(const std::string& cell) {
+    auto parts = split(cell, ':'); if (parts.size() < 2) return {};
+    std::vector<std::string> row = {parts[0], parts[1]};
+    if (parts.size() > 2) for (const auto& p : split(parts[2], ',')) row.push_back(p);
+    return row;
+}
+
+std::vector<std::string> MatrixTester::plan_versions(int revision_limit, int pkg_revision_limit) {
+    auto last = [](std::vector<std::string> v, size_t n) { if (v.size() > n) v.erase(v.begin(), v.end() - n); return v; };
+    std::vector<std::string> py = {"3.13", "3.12", "3.11", "3.10", "3.9", "3.8", "3.7", "2.7"};
+    if (revision_limit > 0 && py.size() > (size_t)revision_limit) py.resize(revision_limit);
+    plan_dims = { py, last(get_all_versions(pkg), pkg_revision_limit > 1 ? pkg_revision_limit : 5) };
+    for (const auto& spec : cfg.matrix_deps) {
+        auto parts = split(spec, ':'); std::vector<std::string> dv; if (parts.empty()) continue;
+        for (const auto& ver : last(get_all_versions(parts[0]), parts.size() > 1 ? std::max(1, std::atoi(parts[1].c_str())) : 5)) dv.push_back(parts[0] + "=" + ver);
+        if (!dv.empty()) plan_dims.push_back(dv);
+    }
+    size_t full = 1; for (const auto& d : plan_dims) full *= d.size();
+    std::vector<std::string> v; for (const auto& row : covering_array(plan_dims, cfg.matrix_strength)) v.push_back(plan_cell(row));
+    // With no more dimensions than the strength, every combination must be covered: nothing to save.
+    if ((size_t)cfg.matrix_strength >= plan_dims.size())
+        std::cout << YELLOW << std::format("⚠️  A {}-wise plan over {} dimensions is the full matrix ({} cells); add --dep <pkg> for a reduction", cfg.matrix_strength, plan_dims.size(), full) << RESET << std::endl;
+    else std::cout << CYAN << std::format("🧮 {}-wise covering array over {} dimensions: {} cells instead of {}", cfg.matrix_strength, plan_dims.size(), v.size(), full) << RESET << std::endl;
+    return v;
+}
+
+void MatrixTester::expand_failures(const std::vector<std::string>& tested, const fs::path& ts, const std::string& pv, bool prof, bool nc) {
+    std::set<std::string> seen(tested.begin(), tested.end()); std::vector<std::string> more; int failing = 0;
+    for (const auto& r : results) if (!(r.install && r.custom_test)) {
+        ++failing;
+        for (const auto& row : expand_around(plan_dims, plan_row(r.version))) if (seen.insert(plan_cell(row)).second) more.push_back(plan_cell(row));
+    }
+    if (more.empty()) return;
+    std::cout << CYAN << std::format("🔬 Expanding around {} failing cells: {} more cells", failing, more.size()) << RESET << std::endl;
+    double predicted = predicted_makespan, actual = actual_makespan; int known = history_cells;
+    parallel_execution(more, ts, pv, prof, nc, true);
+    predicted_makespan += predicted; actual_makespan += actual; history_cells += known;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "spip_utils.h"
+
+// Rows (one value per dimension) such that every combination of values across any `t` dimensions
+// appears in at least one row. Pairwise (t = 2) over 8 Pythons x 10 releases x 5 versions of a key
+// dependency is ~80 rows instead of 400; t >= dims.size() is the full Cartesian product.
+std::vector<std::vector<std::string>> covering_array(const std::vector<std::vector<std::string>>& dims, int t = 2);
+
+// Every row that differs from `row` in exactly one dimension: the cells that tell which factor a
+// failure depends on.
+std::vector<std::vector<std::string>> expand_around(const std::vector<std::vector<std::string>>& dims, const std::vector<std::string>& row);
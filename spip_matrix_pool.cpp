@@ -0,0 +1,77 @@
+#include "spip_matrix_pool.h"
+#include "spip_env.h"
+#include "spip_install.h"
+#include "spip_process.h"
+#include "spip_trash.h"
+#include "spip_env_tier.h"
+#include <sys/file.h>
+#include <fcntl.h>
+#include <cstring>
+
+WorktreePool::~WorktreePool() { for (const auto& [name, fd] : leased) close(fd); }
+
+Config WorktreePool::lease(const std::string& py_ver, int* slot) {
+    std::string safe_v; for (char c : py_ver) if (std::isalnum(c)) safe_v += c;
+    Config tcfg = cfg; fs::path dirty; int n = 0;
+    {
+        std::lock_guard<std::mutex> l(m);
+        for (; ; ++n) {
+            std::string name = std::format("pool_{}_{}", safe_v, n); if (leased.count(name)) continue;
+            int fd = open((cfg.envs_root / (name + ".lock")).c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+            if (fd < 0) throw std::runtime_error(std::format("cannot open {}: {}", (cfg.envs_root / (name + ".lock")).string(), std::strerror(errno)));
+            if (flock(fd, LOCK_EX | LOCK_NB) != 0) { close(fd); continue; }
+            leased[name] = fd; tcfg.project_hash = name; tcfg.project_env_path = cfg.envs_root / name; dirty = cfg.envs_root / (name + ".dirty");
+            break;
+        }
+    }
+    if (slot) *slot = n;
+    SlotPin pin(placement, n);   // first touch: the env's tmpfs pages land on the slot's node
+    if (!fs::exists(tcfg.project_env_path) || !fs::exists(cfg.envs_root / (tcfg.project_hash + ".base"))) {
+        setup_project_env(tcfg, py_ver);
+        fs::path sp = get_site_packages(tcfg); std::ofstream os(cfg.envs_root / (tcfg.project_hash + ".base"));
+        if (!sp.empty()) for (const auto& entry : fs::directory_iterator(sp)) os << entry.path().filename().string() << "\n";
+        std::error_code ec;   // base scripts too, so reset can tell a wheel's console script from the venv's own
+        for (const auto& entry : fs::directory_iterator(tcfg.project_env_path / "bin", ec)) os << "bin/" << entry.path().filename().string() << "\n";
+    } else {
+        note_env_use(cfg, tcfg.project_hash);
+        if (fs::exists(dirty)) reset_to_base(tcfg);
+    }
+    std::ofstream(dirty).close();
+    return tcfg;
+}
+
+void WorktreePool::release(const Config& tcfg, bool reset) {
+    forget_env_changes(tcfg);   // pool envs are never committed: the cell's installs would pile up for the whole run
+    if (reset && reset_to_base(tcfg)) { std::error_code ec; fs::remove(cfg.envs_root / (tcfg.project_hash + ".dirty"), ec); }
+    std::lock_guard<std::mutex> l(m);
+    auto it = leased.find(tcfg.project_hash); if (it == leased.end()) return;
+    close(it->second); leased.erase(it);
+}
+
+bool WorktreePool::reset_to_base(const Config& tcfg) {
+    std::set<std::string> base; std::string line;
+    { std::ifstream ifs(cfg.envs_root / (tcfg.project_hash + ".base")); while (std::getline(ifs, line)) if (!line.empty()) base.insert(line); }
+    fs::path sp = get_site_packages(tcfg); std::vector<fs::path> added; bool touched_base = base.empty() || sp.empty();
+    // Pool bases listed before bin/ was recorded cannot tell new scripts from the venv's own.
+    bool knows_bin = std::any_of(base.begin(), base.end(), [](const std::string& b) { return b.starts_with("bin/"); });
+    if (!sp.empty()) for (const auto& entry : fs::directory_iterator(sp)) {
+        std::string n = entry.path().filename().string(); if (base.count(n)) continue;
+        added.push_back(entry.path());
+        if (!n.ends_with(".dist-info")) continue;
+        std::ifstream rec(entry.path() / "RECORD");
+        while (std::getline(rec, line)) {
+            std::string rel = line.substr(0, line.find(','));
+            if (!rel.starts_with("..")) { if (base.count(rel.substr(0, rel.find('/')))) touched_base = true; continue; }
+            // Console scripts, share/, include/: outside site-packages but inside the env.
+            fs::path in_env = (sp / rel).lexically_normal().lexically_relative(tcfg.project_env_path);
+            if (in_env.empty() || in_env.begin()->string() == ".." || !knows_bin || base.count(in_env.generic_string())) { touched_base = true; continue; }
+            std::error_code ec; if (fs::exists(fs::symlink_status(tcfg.project_env_path / in_env, ec))) added.push_back(tcfg.project_env_path / in_env);
+        }
+    }
+    std::sort(added.begin(), added.end()); added.erase(std::unique(added.begin(), added.end()), added.end());
+    trash_paths(cfg, added);
+    // A wheel that wrote into a package shipped with the base venv cannot be undone from its RECORD alone.
+    ProcOptions opt; opt.cwd = tcfg.project_env_path;
+    if (touched_base) return run_process({"git", "reset", "-q", "--hard"}, opt) == 0 && run_process({"git", "clean", "-q", "-fdx", "-e", ".project_origin"}, opt) == 0;
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "spip_utils.h"
+#include "spip_numa.h"
+
+// Warm worktrees for matrix cells, one family per base Python version. A leased worktree is
+// reset by deleting what the cell installed on top of base (tracked in <name>.base) instead
+// of being removed and checked out again; <name>.lock (flock) keeps concurrent runs apart.
+class WorktreePool {
+    const Config& cfg;
+    const CpuPlacement* placement;
+    std::mutex m;
+    std::map<std::string, int> leased;
+public:
+    WorktreePool(const Config& c, const CpuPlacement* p = nullptr) : cfg(c), placement(p) {}
+    ~WorktreePool();
+    // slot: the pool index, for SlotPin. Throws std::runtime_error when no lock file can be opened.
+    Config lease(const std::string& py_ver, int* slot = nullptr);
+    void release(const Config& tcfg, bool reset = true);
+private:
+    bool reset_to_base(const Config& tcfg);
+};
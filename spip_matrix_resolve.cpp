@@ -1,13 +1,22 @@
 #include "spip_matrix.h"
 #include "spip_install.h"
 
-std::map<std::string, PackageInfo> resolve_only(const std::vector<std::string>& targets, const std::string& version, const std::string& target_py) {
+std::map<std::string, PackageInfo> resolve_only(const std::vector<std::string>& targets, const std::string& version, const std::string& target_py, const std::map<std::string, std::string>& pins, ResolveMemo* memo) {
+    auto norm = [](std::string s) { std::transform(s.begin(), s.end(), s.begin(), ::tolower); std::replace(s.begin(), s.end(), '_', '-'); std::replace(s.begin(), s.end(), '.', '-'); return s; };
+    std::map<std::string, std::string> pinned; for (const auto& [name, ver] : pins) pinned[norm(name)] = ver;
     std::vector<std::string> q = targets; std::set<std::string> v; std::map<std::string, PackageInfo> res; size_t i = 0;
     while(i < q.size()) {
-        std::string n = q[i++]; std::string ln = n; std::transform(ln.begin(), ln.end(), ln.begin(), ::tolower);
-        std::replace(ln.begin(), ln.end(), '_', '-'); std::replace(ln.begin(), ln.end(), '.', '-');
+        std::string n = q[i++]; std::string ln = norm(n);
         if (v.count(ln)) continue;
-        PackageInfo info = (i == 1 && !version.empty()) ? get_package_info(n, version, target_py) : get_package_info(n, "", target_py);
+        auto pin = pinned.find(ln);
+        std::string want = (i == 1 && !version.empty()) ? version : (pin != pinned.end() ? pin->second : "");
+        PackageInfo info;
+        if (memo) {
+            std::shared_ptr<std::mutex> lk; { std::lock_guard<std::mutex> l(memo->m); auto& p = memo->locks[ln]; if (!p) p = std::make_shared<std::mutex>(); lk = p; }
+            std::lock_guard<std::mutex> l(*lk); std::string key = ln + "|" + want + "|" + target_py;
+            bool hit = false; { std::lock_guard<std::mutex> g(memo->m); if (auto it = memo->infos.find(key); it != memo->infos.end()) { info = it->second; hit = true; } }
+            if (!hit) { info = get_package_info(n, want, target_py); std::lock_guard<std::mutex> g(memo->m); memo->infos[key] = info; }
+        } else info = get_package_info(n, want, target_py);
         if (info.wheel_url.empty()) continue;
         res[ln + "-" + info.version] = info; v.insert(ln);
         for (const auto& d : info.dependencies) q.push_back(d);
@@ -3,6 +3,7 @@
 
 std::vector<std::string> MatrixTester::select_versions(bool vary_python, int revision_limit, bool test_all_revisions, int pkg_revision_limit, const std::string& pinned_pkg_ver) {
     std::vector<std::string> v;
+    if (vary_python && cfg.matrix_strength > 0) return plan_versions(revision_limit, pkg_revision_limit);
     if (vary_python) {
         v = {"3.13", "3.12", "3.11", "3.10", "3.9", "3.8", "3.7", "2.7"};
         if (revision_limit > 0 && v.size() > (size_t)revision_limit) v.resize(revision_limit);
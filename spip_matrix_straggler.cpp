@@ -0,0 +1,93 @@
+#include "spip_matrix_straggler.h"
+
+StragglerWatch::StragglerWatch(const Config& c, WorktreePool& p, const CpuPlacement& pl, MemoryBudget& b, DeadlineGate* g, bool pr, int s)
+    : cfg(c), pool(p), placement(pl), budget(b), gate(g), prof(pr), slots(std::max(1, s)) {
+    if (cfg.matrix_speculate > 0) watcher = std::thread([this] { watch(); });
+}
+
+StragglerWatch::~StragglerWatch() {
+    { std::lock_guard<std::mutex> l(m); stopping = true; }
+    wake.notify_all();
+    if (watcher.joinable()) watcher.join();
+}
+
+void StragglerWatch::arm(MatrixCell& c) const {
+    static const long grace = [] { const char* e = std::getenv("SPIP_CELL_GRACE"); return e ? std::atol(e) : 10L; }();
+    c.limit.grace = std::chrono::seconds(grace);
+    if (cfg.matrix_cell_timeout > 0) c.limit.at = std::chrono::steady_clock::now() + std::chrono::milliseconds((long long)(cfg.matrix_cell_timeout * 1000));
+}
+
+void StragglerWatch::begin(MatrixCell& c) {
+    arm(c); c.running_since = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> l(m); running.push_back(&c);
+}
+
+void StragglerWatch::finish(MatrixCell& c) {
+    std::lock_guard<std::mutex> l(m);
+    running.erase(std::remove(running.begin(), running.end(), &c), running.end());
+    if (c.spec && !c.spec->done) c.spec->copy.limit.cancel = true;   // the original got there first
+    if (c.limit.fired && !c.limit.cancel) {
+        c.res.timed_out = true;
+        std::cout << YELLOW << std::format("⏰ {} {} timed out after {:.0f}s", c.pkg, c.ver, cfg.matrix_cell_timeout) << RESET << std::endl;
+    }
+}
+
+void StragglerWatch::settle(MatrixCell& c) {
+    if (!c.spec) return;
+    if (c.spec->th.joinable()) c.spec->th.join();
+    if (c.spec->won) { c.res = c.spec->copy.res; c.busy = c.spec->copy.busy; }   // history learns the copy's time, not the straggler's
+}
+
+void StragglerWatch::watch() {
+    std::unique_lock<std::mutex> l(m);
+    while (!stopping) {
+        wake.wait_for(l, std::chrono::seconds(1));
+        if (stopping || g_interrupted) continue;
+        auto now = std::chrono::steady_clock::now();
+        for (MatrixCell* c : running) {
+            if ((int)running.size() + specs_running >= slots) break;
+            double elapsed = std::chrono::duration<double>(now - c->running_since).count();
+            if (!c->spec && elapsed >= 10 && elapsed > cfg.matrix_speculate * c->predicted) speculate(*c);
+        }
+    }
+}
+
+void StragglerWatch::speculate(MatrixCell& c) {
+    // Refused copies leave c.spec unset, so the next sweep asks again once memory or time frees up.
+    uintmax_t disk = budget.enabled() ? unpacked_bytes(cfg, c.needed) : 0; long kb = 0;
+    if (budget.enabled() && !(kb = budget.try_admit(c.peak_kb, disk))) return;
+    if (gate && !gate->admit(c.predicted)) { if (kb) budget.release(kb, disk); return; }
+    auto s = std::make_shared<Speculation>(); MatrixCell& d = s->copy;
+    d.owner = c.owner; d.pkg = c.pkg; d.ver = c.ver; d.py_ver = c.py_ver; d.pkg_ver = c.pkg_ver; d.test_script = c.test_script;
+    d.script_hash = c.script_hash; d.needed = c.needed; d.predicted = c.predicted; d.res.version = c.res.version;
+    d.peak_kb = c.peak_kb; d.admitted_kb = kb; d.disk_bytes = disk;
+    c.spec = s; ++specs_running;
+    std::cout << MAGENTA << std::format("🐇 {} {} running {:.0f}s (predicted {:.0f}s): starting a speculative copy", c.pkg, c.ver,
+                                        std::chrono::duration<double>(std::chrono::steady_clock::now() - c.running_since).count(), c.predicted) << RESET << std::endl;
+    s->th = std::thread([this, s, &c] {
+        MatrixCell& d = s->copy;
+        // The copy's predicted time leaves the gate with it: the cell's own finish() accounts for the run.
+        auto unreserve = [&] { if (d.admitted_kb) budget.release(d.admitted_kb, d.disk_bytes); if (gate) gate->withdraw(d.predicted); };
+        try { d.tcfg = pool.lease(d.py_ver, &d.slot); d.leased = true; } catch (const std::exception&) {}
+        if (!d.leased) { unreserve(); std::lock_guard<std::mutex> l(m); s->done = true; --specs_running; return; }   // no spare worktree: the original carries on alone
+        arm(d);
+        auto t0 = std::chrono::steady_clock::now();
+        {
+            SlotPin pin(&placement, d.slot); DeadlineScope scope(d.limit);
+            install_cell(d, prof);
+            if (d.admitted_kb) { budget.installed(d.disk_bytes); d.disk_bytes = 0; }
+            if (d.res.install && !d.limit.expired() && !g_interrupted) test_cell(d, prof);
+        }
+        d.busy = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        bool won = false;
+        {
+            std::lock_guard<std::mutex> l(m); s->done = true; --specs_running;
+            // Still running: the copy wins, unless it was cut short itself.
+            if (std::find(running.begin(), running.end(), &c) != running.end() && !d.limit.fired) { s->won = won = true; c.limit.cancel = true; }
+        }
+        if (won) std::cout << MAGENTA << std::format("🐇 Speculative copy of {} {} finished first", d.pkg, d.ver) << RESET << std::endl;
+        SlotPin pin(&placement, d.slot);
+        pool.release(d.tcfg);
+        unreserve();
+    });
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "spip_matrix_pipeline.h"
+#include "spip_matrix_pool.h"
+#include "spip_matrix_admission.h"
+#include "spip_matrix_deadline.h"
+
+// Straggler mitigation. A cell gets SPIP_CELL_TIMEOUT / --cell-timeout seconds (default 1800) for
+// install and test together; then its process groups get SIGTERM and, SPIP_CELL_GRACE seconds
+// later (default 10), SIGKILL. A cell still running after SPIP_SPECULATE / --speculate times its
+// predicted duration (default 3, 0 disables; never before 10 s) is duplicated on a spare worktree
+// while fewer cells than test workers are in flight. Whichever copy finishes first supplies the
+// result, and the other is cancelled the same way. A copy is admitted like any cell, through the
+// memory budget and the --deadline gate; when either refuses, the original carries on alone.
+struct Speculation { MatrixCell copy; std::thread th; bool done = false, won = false; };
+
+class StragglerWatch {
+    const Config& cfg;
+    WorktreePool& pool;
+    const CpuPlacement& placement;
+    MemoryBudget& budget;
+    DeadlineGate* gate;
+    bool prof;
+    int slots, specs_running = 0;
+    std::mutex m;
+    std::condition_variable wake;
+    std::vector<MatrixCell*> running;
+    bool stopping = false;
+    std::thread watcher;
+    void watch();
+    void speculate(MatrixCell& c);   // with m held
+    void arm(MatrixCell& c) const;
+public:
+    StragglerWatch(const Config& cfg, WorktreePool& pool, const CpuPlacement& placement, MemoryBudget& budget, DeadlineGate* gate, bool prof, int slots);
+    ~StragglerWatch();
+    void begin(MatrixCell& c);    // install starts: the timeout runs from here
+    void finish(MatrixCell& c);   // install and test are over for the primary copy
+    void settle(MatrixCell& c);   // cleanup: waits for a speculative copy and keeps the winner's result
+};
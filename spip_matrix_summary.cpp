@@ -1,11 +1,23 @@
 #include "spip_matrix_tester.h"
+#include "spip_env_tier.h"
 
 void MatrixTester::summarize(bool prof) {
     std::cout << "\n🏁 Matrix Test Summary for " << pkg << RESET << std::endl;
-    if (prof) std::cout << std::format("{:<15} {:<10} {:<15} {:<15} {:<15} {:<15}", "Version", "Install", "Pkg Tests", "Custom Test", "Wall Time", "CPU Time") << std::endl;
+    if (prof) std::cout << std::format("{:<15} {:<10} {:<15} {:<15} {:<15} {:<15} {:<12} {:<15} {:<20}", "Version", "Install", "Pkg Tests", "Custom Test", "Wall Time", "CPU Time", "Peak MB", "IO R/W MB", "Stall cpu/mem/io s") << std::endl;
     else std::cout << std::format("{:<15} {:<10} {:<15} {:<15}", "Version", "Install", "Pkg Tests", "Custom Test") << std::endl;
     for (const auto& r : results) {
-        if (prof) std::cout << std::format("{:<15} {:<19} {:<24} {:<24} {:<15.2f} {:<15.2f}", r.version, (r.install ? std::string(GREEN) + "PASS" : std::string(RED) + "FAIL") + std::string(RESET), (r.pkg_tests ? std::string(GREEN) + "PASS" : std::string(YELLOW) + "FAIL/SKIP") + std::string(RESET), (r.custom_test ? std::string(GREEN) + "PASS" : std::string(RED) + "FAIL") + std::string(RESET), r.stats.wall_time_seconds, r.stats.cpu_time_seconds) << std::endl;
+        if (prof) std::cout << std::format("{:<15} {:<19} {:<24} {:<24} {:<15.2f} {:<15.2f} {:<12.1f} {:<15} {:<20}", r.version, (r.install ? std::string(GREEN) + "PASS" : std::string(RED) + "FAIL") + std::string(RESET), (r.pkg_tests ? std::string(GREEN) + "PASS" : std::string(YELLOW) + "FAIL/SKIP") + std::string(RESET), (r.custom_test ? std::string(GREEN) + "PASS" : std::string(RED) + "FAIL") + std::string(RESET), r.stats.wall_time_seconds, r.stats.cpu_time_seconds,
+            r.stats.peak_memory_kb / 1024.0, std::format("{:.1f}/{:.1f}", r.stats.io_read_bytes / 1048576.0, r.stats.io_write_bytes / 1048576.0), std::format("{:.2f}/{:.2f}/{:.2f}", r.stats.cpu_pressure_seconds, r.stats.memory_pressure_seconds, r.stats.io_pressure_seconds)) << std::endl;
         else std::cout << std::format("{:<15} {:<19} {:<24} {:<24}", r.version, (r.install ? std::string(GREEN) + "PASS" : std::string(RED) + "FAIL") + std::string(RESET), (r.pkg_tests ? std::string(GREEN) + "PASS" : std::string(YELLOW) + "FAIL/SKIP") + std::string(RESET), (r.custom_test ? std::string(GREEN) + "PASS" : std::string(RED) + "FAIL") + std::string(RESET)) << std::endl;
     }
+    if (actual_makespan > 0) std::cout << std::format("⏱  Makespan: predicted {:.1f}s, actual {:.1f}s ({}/{} cells had history)", predicted_makespan, actual_makespan, history_cells, results.size() + deadline_skipped.size()) << std::endl;
+    if (TierStats s = tier_stats(); ram_tier_active(cfg) && s.ram_hits + s.disk_hits + s.ram_placements + s.disk_placements > 0)
+        std::cout << std::format("🗄  Env tiers: {} RAM / {} disk hits, {} new envs in RAM, {} on disk, {} spilled ({:.0f} MB)", s.ram_hits, s.disk_hits, s.ram_placements, s.disk_placements, s.spills, s.spilled_bytes / 1048576.0) << std::endl;
+    if (!deadline_skipped.empty()) {
+        std::string list; for (size_t i = 0; i < std::min<size_t>(deadline_skipped.size(), 8); ++i) list += (i ? ", " : "") + deadline_skipped[i];
+        std::cout << YELLOW << std::format("⏳ {} cells skipped to meet the deadline: {}{}", deadline_skipped.size(), list, deadline_skipped.size() > 8 ? ", ..." : "") << RESET << std::endl;
+    }
+    if (size_t timed_out = std::count_if(results.begin(), results.end(), [](const MatrixResult& r) { return r.timed_out; }); timed_out > 0 || speculated_cells > 0)
+        std::cout << std::format("🐢 Stragglers: {} cells timed out, {} speculative copies ({} finished first)", timed_out, speculated_cells, speculation_wins) << std::endl;
+    if (cached_cells > 0) std::cout << std::format("♻️  {}/{} cells reused from earlier runs (--fresh re-runs them)", cached_cells, results.size()) << std::endl;
 }
@@ -4,20 +4,44 @@
 #include "TelemetryLogger.h"
 #include "ErrorKnowledgeBase.h"
 
-struct MatrixResult { std::string version; bool install; bool pkg_tests; bool custom_test; ResourceUsage stats; };
+struct MatrixResult { std::string version; bool install; bool pkg_tests; bool custom_test; ResourceUsage stats; bool timed_out = false; };
 struct MatrixErrorLog { std::string version; std::string python; std::string output; };
 
+// Result cache (spip_matrix_cache.cpp): one row per finished cell, keyed by everything that decides its outcome.
+std::string matrix_cell_key(const Config& cfg, const std::string& pkg, const std::string& pkg_ver, const std::string& py_ver,
+                            const std::map<std::string, PackageInfo>& closure, const std::string& script_hash);
+bool load_cached_result(const Config& cfg, const std::string& key, MatrixResult& out);
+// Latest stored result per (version, Python) of a package, whatever its key.
+std::map<std::pair<std::string, std::string>, MatrixResult> last_outcomes(const Config& cfg, const std::string& pkg);
+void store_cached_result(const Config& cfg, const std::string& key, const std::string& pkg, const std::string& pkg_ver, const std::string& py_ver, const MatrixResult& r);
+
+struct MatrixCell;
+
 class MatrixTester {
     const Config& cfg;
     std::string pkg;
     std::vector<MatrixResult> results;
     std::vector<MatrixErrorLog> error_logs;
+    double predicted_makespan = 0, actual_makespan = 0;
+    int history_cells = 0, cached_cells = 0;
+    std::vector<std::string> deadline_skipped;
+    int speculated_cells = 0, speculation_wins = 0;
+    std::vector<std::vector<std::string>> plan_dims;   // set when the cells come from the covering-array planner
 public:
     MatrixTester(const Config& c, const std::string& p) : cfg(c), pkg(p) {}
-    void run(const std::string& custom_test_script, const std::string& python_version, bool profile, bool no_cleanup, int revision_limit, bool test_all_revisions, bool vary_python, int pkg_revision_limit, const std::string& pinned_pkg_ver);
-    void run_execution_phase(const std::string& custom_test_script, const std::string& python_version, bool profile, bool no_cleanup, int revision_limit, bool test_all_revisions, bool vary_python, int pkg_revision_limit, const std::string& pinned_pkg_ver);
+    void run(const std::string& custom_test_script, const std::string& python_version, bool profile, bool no_cleanup, int revision_limit, bool test_all_revisions, bool vary_python, int pkg_revision_limit, const std::string& pinned_pkg_ver, const std::string& bisect_range = "");
+    // Many packages' cells in one pipeline: shared resolution, downloads, base envs and workers.
+    static void run_batch(const Config& cfg, const std::vector<std::string>& packages, const std::string& custom_test_script, const std::string& python_version, bool profile, bool no_cleanup, int revision_limit, bool test_all_revisions);
+    void run_execution_phase(const std::vector<std::string>& to_do, const std::string& custom_test_script, const std::string& python_version, bool profile, bool no_cleanup, bool vary_python, bool bisecting = false);
 private:
     std::vector<std::string> select_versions(bool vary_python, int revision_limit, bool test_all_revisions, int pkg_revision_limit, const std::string& pinned_pkg_ver);
+    fs::path prepare_test_script(const std::string& custom_test_script);
+    std::vector<std::unique_ptr<MatrixCell>> make_cells(const std::vector<std::string>& to_do, const fs::path& test_script, const std::string& python_version, bool vary_python);
+    static std::pair<double, double> run_pipeline(const Config& cfg, std::vector<std::unique_ptr<MatrixCell>> cells, bool profile, bool no_cleanup);   // {predicted, actual} makespan
     void parallel_execution(const std::vector<std::string>& to_do, const fs::path& test_script, const std::string& python_version, bool profile, bool no_cleanup, bool vary_python);
+    std::vector<std::string> plan_versions(int revision_limit, int pkg_revision_limit);
+    void expand_failures(const std::vector<std::string>& tested, const fs::path& test_script, const std::string& python_version, bool profile, bool no_cleanup);
+    std::vector<std::string> bisect_candidates(const std::string& range, bool vary_python);
+    void bisect(const std::vector<std::string>& candidates, const fs::path& test_script, const std::string& python_version, bool profile, bool no_cleanup, bool vary_python);
     void summarize(bool profile);
 };
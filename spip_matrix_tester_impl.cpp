@@ -1,19 +1,27 @@
 #include "spip_matrix_tester.h"
 #include "spip_env.h"
+#include "spip_process.h"
 
-void MatrixTester::run_execution_phase(const std::string& custom_test_script, const std::string& python_version, bool profile, bool no_cleanup, int revision_limit, bool test_all_revisions, bool vary_python, int pkg_revision_limit, const std::string& pinned_pkg_ver) {
+void MatrixTester::run_execution_phase(const std::vector<std::string>& to_do, const std::string& custom_test_script, const std::string& python_version, bool profile, bool no_cleanup, bool vary_python, bool bisecting) {
     // ... (logic from spip_matrix_tester.cpp continued)
     // Storage for Wheels
-    std::string wb = "wheels"; if (branch_exists(cfg, wb) || run_shell(std::format("cd {} && git branch {}", quote_arg(cfg.repo_path.string()), wb).c_str()) == 0) {
-        fs::path wwt = cfg.spip_root / "wheels_wt"; if (!fs::exists(wwt)) run_shell(std::format("cd {} && git worktree add --detach {} {}", quote_arg(cfg.repo_path.string()), quote_arg(wwt.string()), wb).c_str());
+    ProcOptions at_repo; at_repo.cwd = cfg.repo_path;
+    std::string wb = "wheels"; if (branch_exists(cfg, wb) || run_process({"git", "branch", wb}, at_repo) == 0) {
+        fs::path wwt = cfg.spip_root / "wheels_wt"; if (!fs::exists(wwt)) run_process({"git", "worktree", "add", "--detach", wwt.string(), wb}, at_repo);
         // Copy and commit logic would go here if not exceeding 32 lines.
     }
+    fs::path ts = prepare_test_script(custom_test_script);
+    if (bisecting) { bisect(to_do, ts, python_version, profile, no_cleanup, vary_python); return; }
+    parallel_execution(to_do, ts, python_version, profile, no_cleanup, vary_python);
+    if (cfg.matrix_expand && !plan_dims.empty() && !g_interrupted) expand_failures(to_do, ts, python_version, profile, no_cleanup);
+    summarize(profile);
+}
+
+fs::path MatrixTester::prepare_test_script(const std::string& custom_test_script) {
     fs::path ts = custom_test_script; if (ts.empty()) {
         fs::path gh = cfg.spip_root / "scripts" / "generate_test.py";
-        std::string code = get_exec_output(std::format("python3 {} {}", quote_arg(gh.string()), quote_arg(pkg)));
+        std::string code = get_process_output({"python3", gh.string(), pkg});
         ts = fs::current_path() / ("test_" + pkg + "_gen.py"); std::ofstream os(ts); os << code; os.close();
     }
-    std::vector<std::string> to_do = select_versions(vary_python, revision_limit, test_all_revisions, pkg_revision_limit, pinned_pkg_ver);
-    parallel_execution(to_do, ts, python_version, profile, no_cleanup, vary_python);
-    summarize(profile);
+    return ts;
 }
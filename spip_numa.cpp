@@ -0,0 +1,98 @@
+#include "spip_numa.h"
+#include <sys/file.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+static std::vector<int> parse_cpulist(const std::string& s) {
+    std::vector<int> cpus;
+    for (const auto& r : split(s, ',')) {
+        if (r.empty()) continue;
+        size_t dash = r.find('-'); int a = std::atoi(r.c_str()), b = dash == std::string::npos ? a : std::atoi(r.c_str() + dash + 1);
+        for (int c = a; c <= b; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+static std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set; CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) for (int c = 0; c < CPU_SETSIZE; ++c) if (CPU_ISSET(c, &set)) cpus.push_back(c);
+#endif
+    return cpus;
+}
+
+static bool set_thread_cpus(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set; CPU_ZERO(&set); for (int c : cpus) if (c < CPU_SETSIZE) CPU_SET(c, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;   // 0: the calling thread
+#else
+    (void)cpus; return false;
+#endif
+}
+
+static void prefer_node(int node) {
+#ifdef __linux__
+    if (node < 0) { syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0); return; }
+    unsigned long mask[16] = {}; if (node >= (int)(sizeof(mask) * 8)) return;
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, sizeof(mask) * 8);
+#else
+    (void)node;
+#endif
+}
+
+std::vector<NumaNode> numa_topology() {
+    std::vector<int> allowed = allowed_cpus(); std::set<int> ok(allowed.begin(), allowed.end());
+    std::vector<NumaNode> nodes; std::error_code ec;
+    for (const auto& entry : fs::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (!name.starts_with("node") || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), ::isdigit)) continue;
+        std::ifstream ifs(entry.path() / "cpulist"); std::string list; std::getline(ifs, list);
+        NumaNode n{std::atoi(name.c_str() + 4), {}};
+        for (int c : parse_cpulist(list)) if (ok.count(c)) n.cpus.push_back(c);
+        if (!n.cpus.empty()) nodes.push_back(std::move(n));
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    if (nodes.empty()) nodes.push_back({0, allowed});
+    return nodes;
+}
+
+CpuPlacement CpuPlacement::for_host(const Config& cfg) {
+    CpuPlacement p(numa_topology(), cfg.concurrency);
+    if (p.active()) std::cout << BLUE << std::format("📌 Pinning matrix slots across {} NUMA nodes", p.nodes.size()) << RESET << std::endl;
+    return p;
+}
+
+// The node's slots split its cores evenly; when there are more slots than cores, each gets the whole node.
+std::vector<int> CpuPlacement::cpus_of(int slot) const {
+    const NumaNode& n = node_of(slot);
+    int per_node = (slots + (int)nodes.size() - 1) / (int)nodes.size(), k = (slot / (int)nodes.size()) % per_node;
+    size_t chunk = n.cpus.size() / per_node;
+    if (chunk == 0) return n.cpus;
+    return std::vector<int>(n.cpus.begin() + k * chunk, k == per_node - 1 ? n.cpus.end() : n.cpus.begin() + (k + 1) * chunk);
+}
+
+SlotPin::SlotPin(const CpuPlacement* p, int slot) {
+    if (!p || slot < 0 || !p->active()) return;
+    saved = allowed_cpus();
+    if (!set_thread_cpus(p->cpus_of(slot))) return;
+    prefer_node(p->node_of(slot).id); pinned = true;
+}
+
+SlotPin::~SlotPin() { if (pinned) { set_thread_cpus(saved); prefer_node(-1); } }
+
+int claim_worker_slot(const Config& cfg) {
+    fs::path dir = cfg.spip_root / "worker_slots"; std::error_code ec; fs::create_directories(dir, ec);
+    for (int n = 0; n < 4096; ++n) {
+        int fd = open((dir / std::format("{}.lock", n)).c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+        if (fd < 0) return -1;
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0) return n;   // held until this process exits
+        close(fd);
+    }
+    return -1;
+}
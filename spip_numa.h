@@ -0,0 +1,34 @@
+#pragma once
+#include "spip_utils.h"
+
+// NUMA placement for matrix slots. Topology comes from /sys/devices/system/node, limited to the
+// CPUs this process may run on. Pool worktree n is slot n: it always runs on node n % nodes, on
+// its own share of that node's cores, with memory preferred from that node, so its tmpfs pages
+// stay local from one cell to the next. Only active on multi-node hosts; SPIP_NO_PIN turns it off.
+struct NumaNode { int id; std::vector<int> cpus; };
+std::vector<NumaNode> numa_topology();
+
+class CpuPlacement {
+    std::vector<NumaNode> nodes;
+    int slots;
+public:
+    CpuPlacement(std::vector<NumaNode> n, int s) : nodes(std::move(n)), slots(std::max(1, s)) {}
+    static CpuPlacement for_host(const Config& cfg);   // one slot per unit of concurrency
+    bool active() const { return nodes.size() > 1 && !std::getenv("SPIP_NO_PIN"); }
+    const NumaNode& node_of(int slot) const { return nodes[slot % nodes.size()]; }
+    std::vector<int> cpus_of(int slot) const;
+};
+
+// Pins the calling thread to a slot's cores and prefers its node for memory until destroyed.
+// Processes spawned meanwhile inherit both the CPU mask and the memory policy.
+class SlotPin {
+    std::vector<int> saved;
+    bool pinned = false;
+public:
+    SlotPin(const CpuPlacement* p, int slot);
+    ~SlotPin();
+    SlotPin(const SlotPin&) = delete;
+    SlotPin& operator=(const SlotPin&) = delete;
+};
+
+int claim_worker_slot(const Config& cfg);   // lowest slot no other worker process on this host holds
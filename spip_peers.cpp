@@ -0,0 +1,53 @@
+#include "spip_distributed.h"
+
+// Workers share their wheel caches through the queue DB: each one serves ~/.spip over
+// `spip serve` and lists the wheels it holds; peers are tried before the mirror.
+void advertise_wheels(const Config& cfg, const std::string& peer_url, std::set<std::string>& advertised) {
+    std::vector<fs::path> fresh; std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(cfg.spip_root, ec)) {
+        std::string n = entry.path().filename().string();
+        if (n.ends_with(".whl") && entry.is_regular_file() && !advertised.count(n)) fresh.push_back(entry.path());
+    }
+    sqlite3* db; if (sqlite3_open(get_queue_db_path(cfg).c_str(), &db) != SQLITE_OK) { sqlite3_close(db); return; }
+    sqlite3_busy_timeout(db, 10000); sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt;
+    if (!fresh.empty() && sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO wheel_peers (worker_id, peer_url, wheel, sha256, size, updated_at) VALUES (?, ?, ?, ?, ?, julianday('now'));", -1, &stmt, nullptr) == SQLITE_OK) {
+        for (const auto& p : fresh) {
+            std::string n = p.filename().string(), sha = compute_file_sha256(p); if (sha.empty()) continue;
+            sqlite3_reset(stmt);
+            sqlite3_bind_text(stmt, 1, cfg.worker_id.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 2, peer_url.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 3, n.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 4, sha.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 5, fs::file_size(p, ec));
+            if (sqlite3_step(stmt) == SQLITE_DONE) advertised.insert(n);
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (sqlite3_prepare_v2(db, "UPDATE wheel_peers SET updated_at=julianday('now') WHERE worker_id=?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, cfg.worker_id.c_str(), -1, SQLITE_TRANSIENT); sqlite3_step(stmt); sqlite3_finalize(stmt);
+    }
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr); sqlite3_close(db);
+}
+
+void withdraw_wheels(const Config& cfg) {
+    sqlite3* db; if (sqlite3_open(get_queue_db_path(cfg).c_str(), &db) != SQLITE_OK) { sqlite3_close(db); return; }
+    sqlite3_busy_timeout(db, 10000); sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "DELETE FROM wheel_peers WHERE worker_id=?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, cfg.worker_id.c_str(), -1, SQLITE_TRANSIENT); sqlite3_step(stmt); sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+}
+
+std::vector<std::pair<std::string, std::string>> find_wheel_peers(const Config& cfg, const std::string& wheel) {
+    std::vector<std::pair<std::string, std::string>> peers;
+    sqlite3* db; if (sqlite3_open_v2(get_queue_db_path(cfg).c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) { sqlite3_close(db); return peers; }
+    sqlite3_busy_timeout(db, 2000); sqlite3_stmt* stmt;
+    // Heartbeats refresh updated_at every idle poll; anything silent for 10 minutes is considered gone.
+    const char* sql = "SELECT peer_url, sha256 FROM wheel_peers WHERE wheel=? AND worker_id!=? AND updated_at > julianday('now') - 600.0/86400 ORDER BY random() LIMIT 3;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, wheel.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 2, cfg.worker_id.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) peers.push_back({std::string((const char*)sqlite3_column_text(stmt, 0)) + "/wheels/" + wheel, (const char*)sqlite3_column_text(stmt, 1)});
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return peers;
+}
@@ -0,0 +1,216 @@
+#include "spip_process.h"
+#include <spawn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#endif
+
+extern char** environ;
+
+thread_local ProcAccount* t_proc_account = nullptr;
+thread_local ProcDeadline* t_proc_deadline = nullptr;
+
+bool enforce_deadline(ProcDeadline* d, pid_t pgid, std::chrono::steady_clock::time_point& term_at) {
+    if (!d || pgid <= 0 || !d->expired()) return false;
+    auto now = std::chrono::steady_clock::now();
+    if (term_at == std::chrono::steady_clock::time_point{}) { killpg(pgid, SIGTERM); term_at = now; d->fired = true; }
+    else if (now - term_at >= d->grace) killpg(pgid, SIGKILL);
+    return true;
+}
+
+void account_child_usage(ProcAccount* account, const struct rusage& ru) {
+    if (!account) return;
+    ChildUsage& u = account->usage;
+    u.cpu_seconds += ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    u.peak_rss_kb = std::max(u.peak_rss_kb, (long)ru.ru_maxrss);
+    u.read_bytes += (uintmax_t)ru.ru_inblock * 512; u.write_bytes += (uintmax_t)ru.ru_oublock * 512;
+}
+
+bool join_cgroup(const fs::path& cgroup, pid_t pid) {
+    std::ofstream ofs(cgroup / "cgroup.procs"); ofs << pid << std::flush;
+    return (bool)ofs;
+}
+
+static pid_t spawn_child(const std::vector<std::string>& argv, const ProcOptions& opt, int* out_fd) {
+    if (argv.empty()) return -1;
+    posix_spawn_file_actions_t fa; posix_spawn_file_actions_init(&fa);
+    posix_spawnattr_t at; posix_spawnattr_init(&at);
+    // spip ignores SIGPIPE while serving and handles SIGINT itself; children start with defaults.
+    sigset_t def, none; sigemptyset(&def); sigaddset(&def, SIGPIPE); sigaddset(&def, SIGINT); sigemptyset(&none);
+    posix_spawnattr_setsigdefault(&at, &def); posix_spawnattr_setsigmask(&at, &none);
+    short flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+    if (!opt.foreground) { flags |= POSIX_SPAWN_SETPGROUP; posix_spawnattr_setpgroup(&at, 0); }
+    posix_spawnattr_setflags(&at, flags);
+    int p[2] = {-1, -1};
+    if (opt.capture) {
+#ifdef __linux__
+        if (pipe2(p, O_CLOEXEC) != 0) return -1;
+        fcntl(p[0], F_SETPIPE_SZ, 1 << 20);
+#else
+        if (pipe(p) != 0) return -1;
+        fcntl(p[0], F_SETFD, FD_CLOEXEC); fcntl(p[1], F_SETFD, FD_CLOEXEC);
+#endif
+        posix_spawn_file_actions_adddup2(&fa, p[1], 1);
+        if (opt.merge_stderr) posix_spawn_file_actions_adddup2(&fa, p[1], 2);
+    }
+    if (!opt.stdin_path.empty()) posix_spawn_file_actions_addopen(&fa, 0, opt.stdin_path.c_str(), O_RDONLY, 0);
+    if (!opt.stdout_path.empty()) posix_spawn_file_actions_addopen(&fa, 1, opt.stdout_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    else if (opt.silent && !opt.capture) posix_spawn_file_actions_addopen(&fa, 1, "/dev/null", O_WRONLY, 0);
+    if (opt.quiet && !opt.merge_stderr) posix_spawn_file_actions_addopen(&fa, 2, "/dev/null", O_WRONLY, 0);
+    if (!opt.cwd.empty()) posix_spawn_file_actions_addchdir_np(&fa, opt.cwd.c_str());
+    std::vector<std::string> env_store; std::vector<char*> envp;
+    if (!opt.env.empty()) {
+        for (char** e = environ; *e; ++e) {
+            std::string kv = *e; std::string key = kv.substr(0, kv.find('=') + 1);
+            if (std::none_of(opt.env.begin(), opt.env.end(), [&](const std::string& o) { return o.starts_with(key); })) env_store.push_back(kv);
+        }
+        env_store.insert(env_store.end(), opt.env.begin(), opt.env.end());
+        for (auto& kv : env_store) envp.push_back(kv.data());
+        envp.push_back(nullptr);
+    }
+    std::vector<char*> args; for (const auto& a : argv) args.push_back(const_cast<char*>(a.c_str())); args.push_back(nullptr);
+    pid_t pid = -1;
+    int rc = posix_spawnp(&pid, args[0], &fa, &at, args.data(), envp.empty() ? environ : envp.data());
+    posix_spawn_file_actions_destroy(&fa); posix_spawnattr_destroy(&at);
+    if (p[1] >= 0) close(p[1]);
+    if (rc != 0) { if (p[0] >= 0) close(p[0]); return -1; }
+    if (p[0] >= 0) { fcntl(p[0], F_SETFL, fcntl(p[0], F_GETFL) | O_NONBLOCK); *out_fd = p[0]; }
+    return pid;
+}
+
+ProcessSupervisor::ProcessSupervisor() {
+#ifdef __linux__
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+#endif
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    wait_all();
+    if (epfd >= 0) close(epfd);
+}
+
+bool ProcessSupervisor::submit(const std::vector<std::string>& argv, const ProcOptions& opt, Callback done) {
+    Child c; c.done = std::move(done); c.foreground = opt.foreground; c.account = t_proc_account; c.deadline = opt.foreground ? nullptr : t_proc_deadline;
+    // posix_spawn cannot start a child inside a cgroup, and moving it in from here once the spawn
+    // returns races with its first fork. A sh prelude joins the cgroup from inside the child and
+    // then execs the command under the same pid, so nothing it starts escapes the account.
+    std::vector<std::string> wrapped;
+    if (c.account && !c.account->cgroup.empty() && !argv.empty()) {
+        wrapped = {"/bin/sh", "-c", "{ echo $$ > \"$0\"; } 2>/dev/null; exec \"$@\"", (c.account->cgroup / "cgroup.procs").string()};
+        wrapped.insert(wrapped.end(), argv.begin(), argv.end());
+    }
+    c.pid = spawn_child(wrapped.empty() ? argv : wrapped, opt, &c.out);
+    if (c.pid < 0) {
+        ProcResult r; r.status = 127 << 8;   // what sh reports for a missing command
+        if (c.done) c.done(r);
+        return false;
+    }
+#ifdef __linux__
+    c.pidfd = (int)syscall(SYS_pidfd_open, c.pid, 0);
+    if (epfd >= 0) {
+        epoll_event ev{}; ev.events = EPOLLIN;
+        if (c.pidfd >= 0) { ev.data.u64 = ((uint64_t)c.pid << 1); epoll_ctl(epfd, EPOLL_CTL_ADD, c.pidfd, &ev); }
+        if (c.out >= 0) { ev.data.u64 = ((uint64_t)c.pid << 1) | 1; epoll_ctl(epfd, EPOLL_CTL_ADD, c.out, &ev); }
+    }
+#endif
+    children.emplace(c.pid, std::move(c));
+    return true;
+}
+
+void ProcessSupervisor::drain(Child& c, bool to_eof) {
+    if (c.out < 0) return;
+    char buf[65536];
+    while (true) {
+        ssize_t n = read(c.out, buf, sizeof(buf));
+        if (n > 0) { c.res.out.append(buf, n); continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN && !to_eof) return;
+        break;
+    }
+#ifdef __linux__
+    if (epfd >= 0) epoll_ctl(epfd, EPOLL_CTL_DEL, c.out, nullptr);
+#endif
+    close(c.out); c.out = -1;
+}
+
+void ProcessSupervisor::finish(pid_t pid) {
+    auto it = children.find(pid); if (it == children.end()) return;
+    Child c = std::move(it->second); children.erase(it);
+    // Whatever the child wrote before exiting is already in the pipe; grandchildren that kept it
+    // open do not get to hold up completion.
+    drain(c, true);
+    if (c.pidfd >= 0) close(c.pidfd);
+    int st = c.res.status;
+    if ((WIFSIGNALED(st) && WTERMSIG(st) == SIGINT) || (WIFEXITED(st) && WEXITSTATUS(st) == 130)) g_interrupted = true;
+    if (c.done) c.done(c.res);
+}
+
+void ProcessSupervisor::wait_all() {
+    while (!children.empty()) {
+        if (g_interrupted && !forwarded) {
+            for (auto& [pid, c] : children) if (!c.foreground) killpg(pid, SIGINT);
+            forwarded = true;
+        }
+        for (auto& [pid, c] : children) enforce_deadline(c.deadline, pid, c.term_at);
+        bool polling = epfd < 0 || std::any_of(children.begin(), children.end(), [](const auto& kv) { return kv.second.pidfd < 0; });
+        int timeout = polling ? 20 : 200;
+        std::vector<std::pair<pid_t, bool>> ready;   // (pid, is_output)
+#ifdef __linux__
+        if (epfd >= 0) {
+            epoll_event evs[64]; int n = epoll_wait(epfd, evs, 64, timeout);
+            for (int i = 0; i < n; ++i) ready.push_back({ (pid_t)(evs[i].data.u64 >> 1), (evs[i].data.u64 & 1) != 0 });
+        } else
+#endif
+        {
+            std::vector<pollfd> pfds; std::vector<pid_t> owners;
+            for (auto& [pid, c] : children) if (c.out >= 0) { pfds.push_back({ c.out, POLLIN, 0 }); owners.push_back(pid); }
+            int n = poll(pfds.data(), pfds.size(), timeout);
+            for (size_t i = 0; n > 0 && i < pfds.size(); ++i) if (pfds[i].revents) ready.push_back({ owners[i], true });
+        }
+        std::set<pid_t> check;
+        for (auto [pid, is_out] : ready) {
+            auto it = children.find(pid); if (it == children.end()) continue;
+            if (is_out) drain(it->second, false); else check.insert(pid);
+        }
+        if (polling) for (auto& [pid, c] : children) if (c.pidfd < 0) check.insert(pid);
+        for (pid_t pid : check) {
+            auto it = children.find(pid); if (it == children.end()) continue;
+            int st = 0; struct rusage ru{}; pid_t r = wait4(pid, &st, WNOHANG, &ru);
+            if (r == pid) account_child_usage(it->second.account, ru);
+            if (r == pid || (r < 0 && errno == ECHILD)) { it->second.res.status = r == pid ? st : -1; finish(pid); }
+        }
+    }
+}
+
+ProcResult capture_process(const std::vector<std::string>& argv, ProcOptions opt) {
+    if (g_interrupted) { ProcResult r; r.status = 130 << 8; return r; }
+    opt.capture = true; ProcResult res;
+    ProcessSupervisor sup; sup.submit(argv, opt, [&](const ProcResult& r) { res = r; }); sup.wait_all();
+    return res;
+}
+
+int run_process(const std::vector<std::string>& argv, const ProcOptions& opt) {
+    if (g_interrupted) return 130 << 8;
+    int status = -1;
+    ProcessSupervisor sup; sup.submit(argv, opt, [&](const ProcResult& r) { status = r.status; }); sup.wait_all();
+    return status;
+}
+
+std::string get_process_output(const std::vector<std::string>& argv, ProcOptions opt) {
+    std::string out = capture_process(argv, opt).out;
+    if (!out.empty() && out.back() == '\n') out.pop_back();
+    return out;
+}
+
+std::string find_executable(const std::string& name) {
+    if (name.find('/') != std::string::npos) return access(name.c_str(), X_OK) == 0 ? name : "";
+    const char* path = std::getenv("PATH"); if (!path) return "";
+    for (const auto& dir : split(path, ':')) {
+        fs::path p = fs::path(dir.empty() ? "." : dir) / name;
+        if (access(p.c_str(), X_OK) == 0 && !fs::is_directory(p)) return p.string();
+    }
+    return "";
+}
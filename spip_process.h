@@ -0,0 +1,66 @@
+#pragma once
+#include "spip_utils.h"
+
+// Subprocesses without /bin/sh: argv vectors go straight to posix_spawnp, so nothing needs
+// quote_arg. Children lead their own process group; Ctrl-C lands on spip alone, which forwards
+// SIGINT to every group it supervises once g_interrupted is set. Interactive children (REPLs,
+// sudo, qemu consoles) set `foreground` to stay on the terminal instead.
+struct ProcOptions {
+    fs::path cwd;
+    std::vector<std::string> env;   // extra NAME=value entries on top of the inherited environment
+    fs::path stdin_path;
+    fs::path stdout_path;
+    bool capture = false;           // collect stdout into ProcResult::out
+    bool merge_stderr = false;      // ...and stderr with it
+    bool silent = false;            // stdout to /dev/null
+    bool quiet = false;             // stderr to /dev/null
+    bool foreground = false;
+};
+
+struct ProcResult { int status = -1; std::string out; };   // status is a wait status, as from run_shell
+
+// Accounting scope for one unit of work (a matrix cell). While a thread has one installed, every
+// child it spawns is moved into `cgroup` (when set) and its wait4 rusage is added to `usage`.
+struct ChildUsage { double cpu_seconds = 0; long peak_rss_kb = 0; uintmax_t read_bytes = 0; uintmax_t write_bytes = 0; };
+struct ProcAccount { fs::path cgroup; ChildUsage usage; };
+extern thread_local ProcAccount* t_proc_account;
+void account_child_usage(ProcAccount* account, const struct rusage& ru);
+bool join_cgroup(const fs::path& cgroup, pid_t pid);
+
+// Time limit for one unit of work (a matrix cell). While a thread has one installed, the process
+// groups of its children get SIGTERM once `at` passes or `cancel` is set, and SIGKILL `grace`
+// later if they are still there. `fired` records that something was killed.
+struct ProcDeadline {
+    std::chrono::steady_clock::time_point at = std::chrono::steady_clock::time_point::max();
+    std::chrono::milliseconds grace{10000};
+    std::atomic<bool> cancel{false}, fired{false};
+    bool expired() const { return cancel || std::chrono::steady_clock::now() >= at; }
+};
+extern thread_local ProcDeadline* t_proc_deadline;
+// Sends the next signal in the TERM-then-KILL sequence to `pgid` when `d` has expired; `term_at`
+// remembers when TERM went out. Returns true once the group has been signalled at all.
+bool enforce_deadline(ProcDeadline* d, pid_t pgid, std::chrono::steady_clock::time_point& term_at);
+
+// One thread drives any number of children: exits arrive as pidfd events and output as pipe
+// events on a single epoll set. Not thread-safe; give each thread its own supervisor.
+class ProcessSupervisor {
+public:
+    using Callback = std::function<void(const ProcResult&)>;
+    ProcessSupervisor();
+    ~ProcessSupervisor();
+    bool submit(const std::vector<std::string>& argv, const ProcOptions& opt = {}, Callback done = nullptr);
+    void wait_all();
+    size_t running() const { return children.size(); }
+private:
+    struct Child { pid_t pid = -1; int pidfd = -1; int out = -1; bool foreground = false; ProcAccount* account = nullptr; ProcDeadline* deadline = nullptr; std::chrono::steady_clock::time_point term_at{}; ProcResult res; Callback done; };
+    std::map<pid_t, Child> children;
+    int epfd = -1;
+    bool forwarded = false;
+    void drain(Child& c, bool to_eof);
+    void finish(pid_t pid);
+};
+
+ProcResult capture_process(const std::vector<std::string>& argv, ProcOptions opt = {});
+int run_process(const std::vector<std::string>& argv, const ProcOptions& opt = {});
+std::string get_process_output(const std::vector<std::string>& argv, ProcOptions opt = {});
+std::string find_executable(const std::string& name);
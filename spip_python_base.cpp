@@ -1,5 +1,6 @@
 #include "spip_python.h"
 #include "spip_env.h"
+#include "spip_process.h"
 
 void create_base_version(const Config& cfg, const std::string& version) {
     std::string branch = "base/" + version; if (branch_exists(cfg, branch)) return;
@@ -7,22 +8,23 @@ void create_base_version(const Config& cfg, const std::string& version) {
     std::string safe_v = ""; for(char c : version) if(std::isalnum(c) || c == '.') safe_v += c;
     fs::path temp_venv = cfg.spip_root / ("temp_venv_" + safe_v);
     std::string python_bin = ensure_python_bin(cfg, safe_v);
-    std::string venv_cmd = std::format("{} -m venv {}", quote_arg(python_bin), quote_arg(temp_venv.string()));
-    if (run_shell(venv_cmd.c_str()) != 0) {
+    if (run_process({python_bin, "-m", "venv", temp_venv.string()}) != 0) {
         std::cerr << RED << "❌ Failed to create venv with " << python_bin << RESET << std::endl; std::exit(1);
     }
-    std::string curr_br_cmd = "git symbolic-ref --short HEAD 2>/dev/null || echo HEAD";
-    std::string curr_br = get_exec_output(std::format("cd {} && {}", quote_arg(cfg.repo_path.string()), curr_br_cmd));
-    if (curr_br.empty()) curr_br = "main";
-    else if (curr_br.find('\n') != std::string::npos) curr_br = curr_br.substr(0, curr_br.find('\n'));
-    std::string git_cmd = std::format(
-        "cd \"{}\" && git checkout -b \"{}\" > /dev/null 2>&1 && "
-        "find . -mindepth 1 -maxdepth 1 -not -name \".git\" -exec rm -f {{}} \\; 2>/dev/null || true && "
-        "cp -r \"{}/\"* . && git add -A && git commit -m \"Base Python {}\" > /dev/null 2>&1 && "
-        "git checkout {} > /dev/null 2>&1", cfg.repo_path.string(), branch, temp_venv.string(), version, curr_br);
-    if (run_shell(git_cmd.c_str()) != 0) {
+    // Commit the venv straight from its own directory through a private index: the main checkout
+    // never switches branches and the files are not copied. The tree and index become the snapshot.
+    fs::path temp_index = cfg.spip_root / ("temp_index_" + safe_v); std::error_code ec;
+    fs::remove(temp_venv / ".gitignore", ec); fs::remove(temp_index, ec);
+    ProcOptions opt; opt.cwd = temp_venv; opt.env = { "GIT_INDEX_FILE=" + temp_index.string(), "GIT_DIR=" + (cfg.repo_path / ".git").string() };
+    std::string tree, commit, parent = resolve_ref(cfg.repo_path, "HEAD");
+    if (run_process({"git", "--work-tree=.", "add", "-A"}, opt) == 0) tree = get_process_output({"git", "write-tree"}, opt);
+    if (!tree.empty()) {
+        std::vector<std::string> ct = {"git", "commit-tree", tree, "-m", "Base Python " + version}; if (!parent.empty()) { ct.push_back("-p"); ct.push_back(parent); }
+        commit = get_process_output(ct, opt);
+    }
+    if (commit.empty() || run_process({"git", "branch", branch, commit}, opt) != 0) {
         std::cerr << RED << "❌ Failed to commit base version " << version << RESET << std::endl;
-        fs::remove_all(temp_venv); std::exit(1);
+        fs::remove_all(temp_venv); fs::remove(temp_index, ec); std::exit(1);
     }
-    fs::remove_all(temp_venv);
+    store_base_snapshot(cfg, version, temp_venv, temp_index);
 }
@@ -1,10 +1,11 @@
 #include "spip_python.h"
+#include "spip_process.h"
 
 std::string ensure_python_bin(const Config& cfg, const std::string& version) {
     std::string safe_v = ""; for(char c : version) if(std::isalnum(c) || c == '.') safe_v += c;
     std::string python_bin = "python" + safe_v;
-    if (!get_exec_output(std::format("command -v {} 2>/dev/null", python_bin)).empty()) return python_bin; 
-    if (safe_v == "2.7" && !get_exec_output("command -v python2 2>/dev/null").empty()) return "python2";
+    if (!find_executable(python_bin).empty()) return python_bin;
+    if (safe_v == "2.7" && !find_executable("python2").empty()) return "python2";
     fs::path pythons_dir = cfg.spip_root / "pythons";
     fs::path install_bin_dir = pythons_dir / safe_v / "python" / "bin";
     if (safe_v == "2.7") {
@@ -20,13 +21,12 @@ std::string ensure_python_bin(const Config& cfg, const std::string& version) {
     std::string url = std::format("https://github.com/indygreg/python-build-standalone/releases/download/{}/{}", tag, filename);
     fs::path archive_path = pythons_dir / filename; fs::path dest_dir = pythons_dir / safe_v;
     std::cout << BLUE << "📥 Downloading " << url << "..." << RESET << std::endl;
-    std::string dl_cmd = std::format("curl -L -s -# {} -o {}", quote_arg(url), quote_arg(archive_path.string()));
-    if (run_shell(dl_cmd.c_str()) != 0 || !fs::exists(archive_path) || fs::file_size(archive_path) < 1000) {
+    if (run_process({"curl", "-L", "-s", "-#", url, "-o", archive_path.string()}) != 0 || !fs::exists(archive_path) || fs::file_size(archive_path) < 1000) {
         std::cerr << RED << "❌ Failed to download Python " << full_ver << " from " << url << RESET << std::endl; return "python3"; 
     }
     std::cout << BLUE << "📦 Unpacking to " << dest_dir.string() << "..." << RESET << std::endl;
     fs::create_directories(dest_dir);
-    run_shell(std::format("tar -xzf {} -C {}", quote_arg(archive_path.string()), quote_arg(dest_dir.string())).c_str());
+    run_process({"tar", "-xzf", archive_path.string(), "-C", dest_dir.string()});
     fs::remove(archive_path);
     local_python = dest_dir / "python" / "bin" / (safe_v == "2.7" ? "python" : "python3");
     return fs::exists(local_python) ? local_python.string() : "python3";
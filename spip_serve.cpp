@@ -0,0 +1,169 @@
+#include "spip_serve.h"
+#include "spip_db.h"
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <unordered_map>
+
+// One connection of the mirror: request bytes come in, then a header (plus any generated
+// body) is written, then the file, if any, goes out with sendfile straight from the page cache.
+struct ServeConn { std::string in; std::string out; size_t out_off = 0; int file_fd = -1; off_t file_off = 0; off_t file_end = 0; bool keep_alive = true; };
+
+static bool safe_name(const std::string& s) {
+    if (s.empty() || s[0] == '.') return false;
+    for (char c : s) if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-' && c != '+') return false;
+    return true;
+}
+
+// PEP 503: lowercase, with every run of '-', '_' and '.' collapsed to one '-'.
+static std::string normalize_project(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '-' || c == '_' || c == '.') { if (out.empty() || out.back() != '-') out += '-'; }
+        else out += (char)std::tolower(static_cast<unsigned char>(c));
+    }
+    return out;
+}
+
+// Cached wheels with their upstream filenames, from the <wheel>.name files the downloader leaves.
+// Wheels cached before those existed stay reachable under their cache names only.
+static std::vector<std::pair<std::string, fs::path>> published_wheels(const Config& cfg) {
+    std::vector<std::pair<std::string, fs::path>> out; std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(cfg.spip_root, ec)) {
+        std::string n = entry.path().filename().string(); if (!n.ends_with(".whl.name")) continue;
+        fs::path whl = entry.path().parent_path() / n.substr(0, n.size() - 5); std::string real;
+        { std::ifstream ifs(entry.path()); std::getline(ifs, real); }
+        if (real.ends_with(".whl") && safe_name(real) && fs::exists(whl, ec)) out.push_back({real, whl});
+    }
+    return out;
+}
+
+static std::string simple_index(const Config& cfg, const std::string& pkg) {
+    std::string want = normalize_project(pkg);
+    std::string body = std::format("<!DOCTYPE html>\n<html><head><title>Links for {}</title></head><body>\n<h1>Links for {}</h1>\n", pkg, pkg);
+    for (const auto& [real, whl] : published_wheels(cfg))
+        if (normalize_project(real.substr(0, real.find('-'))) == want) body += std::format("<a href=\"/wheels/{}\">{}</a><br/>\n", real, real);
+    return body + "</body></html>\n";
+}
+
+// /wheels/<file>: a cache name (what spip clients ask for) or a published upstream filename.
+static fs::path wheel_file(const Config& cfg, const std::string& name) {
+    std::error_code ec; fs::path direct = cfg.spip_root / name;
+    if (fs::exists(direct, ec)) return direct;
+    for (const auto& [real, whl] : published_wheels(cfg)) if (real == name) return whl;
+    return direct;
+}
+
+static void route(const Config& cfg, ServeConn& c, const std::string& method, std::string path) {
+    if (path.find('?') != std::string::npos) path = path.substr(0, path.find('?'));
+    auto parts = split(path, '/'); parts.erase(std::remove(parts.begin(), parts.end(), ""), parts.end());
+    std::string type = "application/octet-stream", body; fs::path file; int status = 200;
+    if (method != "GET" && method != "HEAD") status = 405;
+    else if (parts.size() == 3 && parts[0] == "pypi" && parts[2] == "json" && safe_name(parts[1])) { file = get_db_path(parts[1]); type = "application/json"; }
+    else if (parts.size() == 2 && parts[0] == "simple" && safe_name(parts[1])) { body = simple_index(cfg, parts[1]); type = "text/html"; }
+    else if (parts.size() == 2 && parts[0] == "wheels" && safe_name(parts[1]) && parts[1].ends_with(".whl")) file = wheel_file(cfg, parts[1]);
+    else if (parts.size() == 2 && parts[0] == "deltas" && safe_name(parts[1]) && parts[1].ends_with(".vcdiff")) file = cfg.spip_root / "delta_cache" / parts[1];
+    else status = 404;
+    if (!file.empty()) {
+        c.file_fd = open(file.c_str(), O_RDONLY | O_CLOEXEC); struct stat st;
+        if (c.file_fd < 0 || fstat(c.file_fd, &st) != 0 || st.st_size == 0) { if (c.file_fd >= 0) close(c.file_fd); c.file_fd = -1; status = 404; }
+        else { c.file_off = 0; c.file_end = st.st_size; }
+    }
+    if (status != 200) { body = status == 404 ? "Not Found\n" : "Method Not Allowed\n"; type = "text/plain"; }
+    size_t len = c.file_fd >= 0 ? static_cast<size_t>(c.file_end) : body.size();
+    c.out = std::format("HTTP/1.1 {} {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: {}\r\n\r\n", status, status == 200 ? "OK" : (status == 404 ? "Not Found" : "Method Not Allowed"), type, len, c.keep_alive ? "keep-alive" : "close");
+    if (method == "HEAD") { if (c.file_fd >= 0) close(c.file_fd); c.file_fd = -1; }
+    else c.out += body;
+    c.out_off = 0;
+}
+
+// Returns false when the peer closed or misbehaved and the connection should be dropped.
+static bool on_readable(ServeConn& c, int fd) {
+    char buf[16384];
+    while (true) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) { c.in.append(buf, n); if (c.in.size() > 65536) return false; continue; }
+        if (n == 0) return false;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+        if (errno != EINTR) return false;
+    }
+}
+
+static void next_request(const Config& cfg, ServeConn& c) {
+    if (!c.out.empty()) return;
+    size_t end = c.in.find("\r\n\r\n"); if (end == std::string::npos) return;
+    std::string head = c.in.substr(0, end); c.in.erase(0, end + 4);
+    std::stringstream ss(head); std::string method, path, proto; ss >> method >> path >> proto;
+    std::string low = head; std::transform(low.begin(), low.end(), low.begin(), ::tolower);
+    c.keep_alive = (proto == "HTTP/1.1") ? low.find("connection: close") == std::string::npos : low.find("connection: keep-alive") != std::string::npos;
+    route(cfg, c, method, path);
+}
+
+static bool on_writable(ServeConn& c, int fd) {
+    while (c.out_off < c.out.size()) {
+        ssize_t n = send(fd, c.out.data() + c.out_off, c.out.size() - c.out_off, MSG_NOSIGNAL);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        c.out_off += n;
+    }
+    while (c.file_fd >= 0 && c.file_off < c.file_end) {
+        ssize_t n = sendfile(fd, c.file_fd, &c.file_off, c.file_end - c.file_off);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        if (n == 0) break;
+    }
+    if (c.file_fd >= 0) { close(c.file_fd); c.file_fd = -1; }
+    c.out.clear(); c.out_off = 0;
+    return c.keep_alive;
+}
+
+void serve_mirror(const Config& cfg, const std::string& bind_addr, int port, std::function<void(int)> on_listen) {
+    std::signal(SIGPIPE, SIG_IGN);
+    int lfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0); int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{}; addr.sin_family = AF_INET; addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bind_addr.c_str(), &addr.sin_addr) != 1 || bind(lfd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(lfd, SOMAXCONN) != 0) {
+        std::cerr << RED << "❌ Could not listen on " << bind_addr << ":" << port << ": " << std::strerror(errno) << RESET << std::endl; close(lfd); return;
+    }
+    socklen_t alen = sizeof(addr); getsockname(lfd, (sockaddr*)&addr, &alen); port = ntohs(addr.sin_port);
+    if (on_listen) on_listen(port);
+    int ep = epoll_create1(EPOLL_CLOEXEC); epoll_event ev{}; ev.events = EPOLLIN; ev.data.fd = lfd; epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+    std::unordered_map<int, ServeConn> conns; std::vector<epoll_event> events(1024);
+    std::cout << GREEN << "🛰  Serving vault and wheel cache on http://" << bind_addr << ":" << port << " (set SPIP_MIRROR on clients)" << RESET << std::endl;
+    auto drop = [&](int fd) { auto it = conns.find(fd); if (it != conns.end() && it->second.file_fd >= 0) close(it->second.file_fd); conns.erase(fd); epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr); close(fd); };
+    auto want = [&](int fd, uint32_t e) { epoll_event m{}; m.events = e | EPOLLRDHUP; m.data.fd = fd; epoll_ctl(ep, EPOLL_CTL_MOD, fd, &m); };
+    while (!g_interrupted) {
+        int n = epoll_wait(ep, events.data(), events.size(), 500);
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd; uint32_t e = events[i].events;
+            if (fd == lfd) {
+                int cfd; while ((cfd = accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    conns[cfd]; epoll_event ce{}; ce.events = EPOLLIN | EPOLLRDHUP; ce.data.fd = cfd; epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &ce);
+                }
+                continue;
+            }
+            auto& c = conns[fd];
+            if (e & (EPOLLERR | EPOLLHUP)) { drop(fd); continue; }
+            bool peer_open = true;
+            if (e & EPOLLIN) peer_open = on_readable(c, fd);
+            next_request(cfg, c);
+            if (!c.out.empty() && !on_writable(c, fd)) { drop(fd); continue; }
+            next_request(cfg, c);
+            if (c.out.empty() && (!peer_open || (e & EPOLLRDHUP))) { drop(fd); continue; }
+            want(fd, c.out.empty() ? EPOLLIN : EPOLLOUT);
+        }
+    }
+    for (auto it = conns.begin(); it != conns.end();) { int fd = it->first; ++it; drop(fd); }
+    close(ep); close(lfd);
+}
+#else
+void serve_mirror(const Config&, const std::string&, int, std::function<void(int)>) {
+    std::cerr << RED << "❌ spip serve requires Linux (epoll/sendfile)." << RESET << std::endl;
+}
+#endif
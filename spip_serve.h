@@ -0,0 +1,4 @@
+#pragma once
+#include "spip_utils.h"
+
+void serve_mirror(const Config& cfg, const std::string& bind_addr = "0.0.0.0", int port = 8080, std::function<void(int)> on_listen = nullptr);
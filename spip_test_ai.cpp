@@ -1,5 +1,7 @@
 #include "spip_test.h"
 #include "spip_install.h"
+#include "spip_env.h"
+#include "spip_process.h"
 
 void review_code(const Config& cfg) {
     const char* k = std::getenv("GEMINI_API_KEY");
@@ -7,19 +9,16 @@ void review_code(const Config& cfg) {
     std::cout << MAGENTA << "🤖 Preparing AI Code Review (Gemini Pro)..." << RESET << std::endl;
     fs::path h = cfg.spip_root / "scripts" / "review_helper.py";
     fs::path py = cfg.project_env_path / "bin" / "python";
-    std::string cmd = std::format("\"{}\" \"{}\" \"{}\" \"{}\"", py.string(), h.string(), k, cfg.current_project.string());
-    run_shell(cmd.c_str());
+    run_process({py.string(), h.string(), k, cfg.current_project.string()});
 }
 
 void verify_environment(const Config& cfg) {
     fs::path sp = get_site_packages(cfg); if (sp.empty()) return;
     std::cout << MAGENTA << "🔍 Verifying environment integrity..." << RESET << std::endl;
     fs::path h = cfg.spip_root / "scripts" / "verify_helper.py";
-    fs::path py = cfg.project_env_path / "bin" / "python";
-    std::string cmd = std::format("{} {} {} {}", quote_arg(py.string()), quote_arg(h.string()), quote_arg(sp.string()), quote_arg((cfg.project_env_path / "bin").string()));
-    if (run_shell(cmd.c_str()) != 0) {
+    if (run_env_python(cfg, {h.string(), sp.string(), (cfg.project_env_path / "bin").string()}).status != 0) {
         std::cout << RED << "❌ VERIFICATION FAILED!" << RESET << std::endl;
-        std::string reset_cmd = std::format("cd \"{}\" && git reset --hard HEAD^", cfg.project_env_path.string());
-        run_shell(reset_cmd.c_str()); std::exit(1);
+        ProcOptions opt; opt.cwd = cfg.project_env_path;
+        run_process({"git", "reset", "--hard", "HEAD^"}, opt); std::exit(1);
     } else std::cout << GREEN << "✨ Verification complete." << RESET << std::endl;
 }
\ No newline at end of file
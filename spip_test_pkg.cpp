@@ -1,5 +1,7 @@
 #include "spip_test.h"
 #include "spip_install.h"
+#include "spip_env.h"
+#include "spip_process.h"
 
 void run_package_tests(const Config& cfg, const std::string& pkg) {
     const fs::path sp = get_site_packages(cfg);
@@ -24,13 +26,10 @@ void run_package_tests(const Config& cfg, const std::string& pkg) {
     }
     std::cout << MAGENTA << "🧪 Testing " << pkg << "..." << RESET << std::endl;
     const fs::path bin = cfg.project_env_path / "bin" / "python";
-    const std::string py_check = std::format("{} -c \"import importlib.util; exit(0 if importlib.util.find_spec('pytest') else 1)\"", quote_arg(bin.string()));
-    if (run_shell(py_check.c_str()) != 0) {
-        const std::string inst_pytest = std::format("{} -m pip install pytest", quote_arg(bin.string()));
-        run_shell(inst_pytest.c_str());
+    if (run_env_python(cfg, {"-c", "import importlib.util; exit(0 if importlib.util.find_spec('pytest') else 1)"}).status != 0) {
+        run_process({bin.string(), "-m", "pip", "install", "pytest"});
     }
-    const std::string test_cmd = std::format("{} -m pytest {}", quote_arg(bin.string()), quote_arg(path.string()));
-    run_shell(test_cmd.c_str());
+    run_env_python(cfg, {"-m", "pytest", path.string()});
 }
 
 void run_all_package_tests(const Config& cfg) {
@@ -2,6 +2,7 @@
 #include "spip_utils.h"
 #include "spip_db.h"
 #include "spip_install.h"
+#include "spip_process.h"
 
 void show_top_downloads();
 void show_top_references();
@@ -15,7 +16,7 @@ void show_top_packages(bool refs, bool deps) {
 
 void show_top_downloads() {
     std::cout << MAGENTA << "🏆 Top 10 PyPI Packages (Downloads)..." << RESET << std::endl;
-    std::string j = get_exec_output("curl -s https://hugovk.github.io/top-pypi-packages/top-pypi-packages-30-days.json");
+    std::string j = get_process_output({"curl", "-s", "https://hugovk.github.io/top-pypi-packages/top-pypi-packages-30-days.json"});
     size_t pos = 0; for (int r = 1; r <= 10; ++r) {
         size_t pk = j.find("\"project\":", pos); if (pk == std::string::npos) break;
         size_t s = j.find("\"", pk + 10); size_t e = j.find("\"", s + 1);
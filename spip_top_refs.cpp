@@ -2,10 +2,11 @@
 #include "spip_utils.h"
 #include "spip_db.h"
 #include "spip_install.h"
+#include "spip_process.h"
 
 void show_top_references() {
     std::cout << MAGENTA << "🏆 Top 10 PyPI Packages (References)..." << RESET << std::endl;
-    std::string h = get_exec_output("curl -L -s -H \"User-Agent: Mozilla/5.0\" \"https://libraries.io/search?languages=Python&order=desc&platforms=Pypi&sort=dependents_count\"");
+    std::string h = get_process_output({"curl", "-L", "-s", "-H", "User-Agent: Mozilla/5.0", "https://libraries.io/search?languages=Python&order=desc&platforms=Pypi&sort=dependents_count"});
     if (h.empty() || h.find("Login to Libraries.io") != std::string::npos) { show_top_packages(false, false); return; }
     std::regex re(R"(<h5>\s*<a href=\"/pypi/[^\"]+\">([^<]+)</a>)");
     auto begin = std::sregex_iterator(h.begin(), h.end(), re); int r = 1;
@@ -0,0 +1,90 @@
+#include "spip_trash.h"
+#include <condition_variable>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace {
+struct Reaper {
+    std::mutex m;
+    std::condition_variable wake, progress;
+    bool started = false;
+    long tid = 0;      // the reaper thread, for ioprio_set from waiters
+    int waiters = 0;   // callers blocked in wait_below; the reaper runs at best-effort I/O meanwhile
+    std::vector<fs::path> dirs;   // one trash per tier, so a rename never crosses filesystems
+    std::atomic<unsigned> seq{0};
+};
+// Never destroyed: the detached reaper thread may still be running while statics are torn down.
+Reaper& reaper() { static auto* r = new Reaper; return *r; }
+
+size_t pending(const std::vector<fs::path>& dirs) {
+    std::error_code ec; size_t n = 0;
+    for (const auto& dir : dirs) for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) ++n;
+    return n;
+}
+
+// The idle class only gets the disk when nobody else wants it, which is right until a caller is
+// waiting on the reaper: then it is on the critical path and competes like everyone else.
+void set_io_class(long tid, bool idle) {
+#ifdef __linux__
+    if (tid) syscall(SYS_ioprio_set, 1, tid, idle ? 3 << 13 : (2 << 13) | 4);   // IOPRIO_WHO_PROCESS; IOPRIO_CLASS_IDLE or BE level 4
+#endif
+}
+
+void reap(std::vector<fs::path> dirs) {
+    Reaper& r = reaper();
+#ifdef __linux__
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+    { std::lock_guard<std::mutex> l(r.m); r.tid = syscall(SYS_gettid); set_io_class(r.tid, r.waiters == 0); }
+#endif
+    while (true) {
+        std::vector<fs::path> batch; std::error_code ec;
+        for (const auto& dir : dirs) for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) batch.push_back(it->path());
+        for (const auto& p : batch) { fs::remove_all(p, ec); r.progress.notify_all(); }
+        std::unique_lock<std::mutex> l(r.m);
+        if (pending(dirs) == 0) r.wake.wait_for(l, std::chrono::seconds(5));
+    }
+}
+
+// envs/.trash, and envs_disk/.trash for disk-tier envs when envs/ is a RAM tmpfs.
+const std::vector<fs::path>& start_reaper(const Config& cfg) {
+    Reaper& r = reaper();
+    std::lock_guard<std::mutex> l(r.m);
+    if (!r.started) {
+        r.dirs = {cfg.envs_root / ".trash", cfg.spip_root / "envs_disk" / ".trash"};
+        std::error_code ec; fs::create_directories(r.dirs[0], ec); r.started = true; std::thread(reap, r.dirs).detach();
+    }
+    return r.dirs;
+}
+
+void wait_below(const std::vector<fs::path>& dirs, size_t n) {
+    Reaper& r = reaper(); std::unique_lock<std::mutex> l(r.m);
+    if (pending(dirs) <= n) return;
+    if (r.waiters++ == 0) set_io_class(r.tid, false);
+    while (pending(dirs) > n) { r.wake.notify_one(); r.progress.wait_for(l, std::chrono::milliseconds(100)); }
+    if (--r.waiters == 0) set_io_class(r.tid, true);
+}
+}
+
+void trash_paths(const Config& cfg, const std::vector<fs::path>& paths) {
+    if (paths.empty()) return;
+    static const size_t limit = [] { const char* e = std::getenv("SPIP_TRASH_LIMIT"); return (size_t)std::max(1, e ? std::atoi(e) : 256); }();
+    const auto& dirs = start_reaper(cfg);
+    wait_below(dirs, limit - 1);
+    Reaper& r = reaper();
+    for (const auto& p : paths) {
+        std::error_code ec; std::string n = std::format("{}-{}-{}", getpid(), r.seq++, p.filename().string());
+        for (const auto& dir : dirs) {
+            if (dir != dirs.front()) { if (ec.value() != EXDEV) break; fs::create_directories(dir, ec); }
+            fs::rename(p, dir / n, ec); if (!ec) break;
+        }
+        if (ec && fs::exists(p)) fs::remove_all(p, ec);   // e.g. outside both tiers: delete in place
+    }
+    { std::lock_guard<std::mutex> l(r.m); }   // the reaper is either past its emptiness check or waiting
+    r.wake.notify_one();
+}
+
+void drain_trash(const Config& cfg) {
+    if (pending({cfg.envs_root / ".trash", cfg.spip_root / "envs_disk" / ".trash"}) == 0) return;
+    wait_below(start_reaper(cfg), 0);
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "spip_utils.h"
+
+// Deferred deletion. Paths are renamed into <envs>/.trash, or <envs_disk>/.trash for disk-tier envs
+// (one metadata operation on the same filesystem) and a background reaper at nice 19 / idle I/O class deletes them off the critical
+// path. When more than SPIP_TRASH_LIMIT entries (default 256) are waiting, callers block until the
+// reaper catches up, and the reaper runs at best-effort I/O priority for as long as anyone is blocked. Trash left when spip exits is reaped by the next run or `spip gc`.
+void trash_paths(const Config& cfg, const std::vector<fs::path>& paths);
+inline void trash_path(const Config& cfg, const fs::path& p) { trash_paths(cfg, {p}); }
+void drain_trash(const Config& cfg);   // wait until the trash is empty
@@ -6,6 +6,11 @@ struct ResourceUsage {
     long peak_memory_kb;
     double wall_time_seconds;
     intmax_t disk_delta_bytes;
+    uintmax_t io_read_bytes = 0;
+    uintmax_t io_write_bytes = 0;
+    double cpu_pressure_seconds = 0;     // PSI "some" stall time, cgroup runs only
+    double memory_pressure_seconds = 0;
+    double io_pressure_seconds = 0;
 };
 
 struct Config {
@@ -20,6 +25,17 @@ struct Config {
     std::string pypi_mirror = "https://pypi.org";
     int concurrency = std::thread::hardware_concurrency();
     bool telemetry = false;
+    bool offline = false;
+    bool peer_sharing = false;
+    bool snapshot_envs = true;
+    bool forkserver = true;
+    bool matrix_cache = true;
+    int matrix_strength = 0;                  // >0: plan vary-python matrices as a t-wise covering array
+    std::vector<std::string> matrix_deps;     // extra planner dimensions: "name" or "name:N" (last N versions)
+    bool matrix_expand = false;               // rerun the one-factor neighbourhood of failing planned cells
+    double matrix_cell_timeout = 1800;        // seconds for one cell's install and test (0: none)
+    double matrix_speculate = 3;              // duplicate cells running this many times their prediction (0: never)
+    std::chrono::steady_clock::time_point matrix_deadline{};   // --deadline: finish the matrix by then (epoch: no deadline)
     std::string worker_id = "worker_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count() % 10000);
 };
 
@@ -28,5 +44,6 @@ struct PackageInfo {
     std::string version;
     std::string wheel_url;
     std::string requires_python;
+    std::string sha256;
     std::vector<std::string> dependencies;
 };
@@ -1,4 +1,5 @@
 #include "spip_utils.h"
+#include "spip_process.h"
 
 std::string compute_hash(const std::string& s) {
     uint64_t h = 0xcbf29ce484222325;
@@ -10,6 +11,13 @@ std::string compute_hash(const std::string& s) {
     return ss.str().substr(0, 16);
 }
 
+std::string compute_file_sha256(const fs::path& p) {
+    ProcOptions opt; opt.quiet = true;
+    ProcResult r = capture_process({"sha256sum", p.string()}, opt); if (r.status != 0) r = capture_process({"shasum", "-a", "256", p.string()}, opt);
+    std::string out = r.status == 0 ? r.out : "";
+    return out.substr(0, out.find(' '));
+}
+
 std::vector<std::string> split(const std::string& s, char delim) {
     std::vector<std::string> parts;
     std::stringstream ss(s);
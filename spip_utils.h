@@ -2,6 +2,7 @@
 #include "spip_types.h"
 
 std::string compute_hash(const std::string& s);
+std::string compute_file_sha256(const fs::path& p);
 std::vector<std::string> split(const std::string& s, char delim);
 std::string quote_arg(const std::string& arg);
 int run_shell(const char* cmd);
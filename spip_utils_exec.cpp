@@ -1,15 +1,7 @@
 #include "spip_utils.h"
+#include "spip_process.h"
 
 std::string get_exec_output(const std::string& cmd) {
-    std::string result;
-    char buffer[128];
-    std::string full_cmd = cmd + " 2>&1";
-    FILE* pipe = popen(full_cmd.c_str(), "r");
-    if (!pipe) return "";
-    while (fgets(buffer, sizeof(buffer), pipe) != NULL) {
-        result += buffer;
-    }
-    pclose(pipe);
-    if (!result.empty() && result.back() == '\n') result.pop_back();
-    return result;
+    ProcOptions opt; opt.merge_stderr = true;
+    return get_process_output({"/bin/sh", "-c", cmd}, opt);
 }
@@ -1,4 +1,5 @@
 #include "spip_utils.h"
+#include "spip_process.h"
 
 std::string quote_arg(const std::string& arg) {
     std::string result = "\"";
@@ -10,13 +11,8 @@ std::string quote_arg(const std::string& arg) {
     return result;
 }
 
+// Kept for commands that genuinely need a shell; everything else should build an argv for run_process.
 int run_shell(const char* cmd) {
-    if (g_interrupted) return 130;
-    int ret = std::system(cmd);
-    if ((WIFSIGNALED(ret) && WTERMSIG(ret) == SIGINT) || 
-        (WIFEXITED(ret) && WEXITSTATUS(ret) == 130)) {
-        g_interrupted = true;
-    }
-    return ret;
+    ProcOptions opt; opt.foreground = true;
+    return run_process({"/bin/sh", "-c", cmd}, opt);
 }
-
@@ -1,25 +1,57 @@
 #include "spip_distributed.h"
 #include "spip_env.h"
 #include "spip_matrix.h"
+#include "spip_serve.h"
+#include "spip_numa.h"
 
 void run_worker(Config& cfg) {
     setup_project_env(cfg); init_queue_db(cfg);
     std::cout << CYAN << "👷 SPIP Worker [" << cfg.worker_id << "] started." << RESET << std::endl;
-    sqlite3* db; sqlite3_open((cfg.spip_root / "queue.db").c_str(), &db); sqlite3_busy_timeout(db, 10000);
+    // Workers on one host take a NUMA node each, round-robin; threads and tasks started below inherit it.
+    CpuPlacement nodes(numa_topology(), 1); int slot = nodes.active() ? claim_worker_slot(cfg) : -1;
+    SlotPin pin(&nodes, slot);
+    if (slot >= 0) std::cout << BLUE << std::format("📌 Worker pinned to NUMA node {}", nodes.node_of(slot).id) << RESET << std::endl;
+    cfg.peer_sharing = !std::getenv("SPIP_NO_PEERS");
+    std::atomic<int> peer_port{0}; std::thread peer_srv; std::string peer_url; std::set<std::string> advertised;
+    if (cfg.peer_sharing) peer_srv = std::thread([&]() { serve_mirror(cfg, "0.0.0.0", 0, [&](int p) { peer_port = p; }); });
+    sqlite3* db; sqlite3_open(get_queue_db_path(cfg).c_str(), &db); sqlite3_busy_timeout(db, 10000);
     while (!g_interrupted) {
-        sqlite3_stmt* stmt; const char* sql = "UPDATE work_queue SET status='CLAIMED', worker_id=?, started_at=julianday('now') WHERE id = (SELECT id FROM work_queue WHERE status='PENDING' LIMIT 1) RETURNING id, pkg_name, pkg_ver, py_ver;";
+        if (peer_port && peer_url.empty()) {
+            const char* h = std::getenv("SPIP_PEER_HOST"); char host[256] = "localhost"; if (!h) { gethostname(host, sizeof(host)); h = host; }
+            peer_url = std::format("http://{}:{}", h, peer_port.load());
+        }
+        if (!peer_url.empty()) advertise_wheels(cfg, peer_url, advertised);
+        // A pending task, or else (with speculation on) a duplicate of the oldest task that has run
+        // SPIP_SPECULATE times the average finished task and is not duplicated yet. Only the first
+        // copy to finish gets to record the outcome.
+        bool spec = false; sqlite3_stmt* stmt; const char* sql = "UPDATE work_queue SET status='CLAIMED', worker_id=?, started_at=julianday('now') WHERE id = (SELECT id FROM work_queue WHERE status='PENDING' LIMIT 1) RETURNING id, pkg_name, pkg_ver, py_ver;";
         if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) { std::this_thread::sleep_for(std::chrono::seconds(1)); continue; }
         sqlite3_bind_text(stmt, 1, cfg.worker_id.c_str(), -1, SQLITE_TRANSIENT);
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_ROW && cfg.matrix_speculate > 0) {
+            sqlite3_finalize(stmt);
+            const char* dup = "UPDATE work_queue SET spec_worker=?1 WHERE id = (SELECT id FROM work_queue WHERE status='CLAIMED' AND spec_worker IS NULL AND worker_id != ?1 "
+                              "AND (julianday('now') - started_at) * 86400 > ?2 * MAX(10, (SELECT AVG((finished_at - started_at) * 86400) FROM work_queue WHERE status='COMPLETED')) "
+                              "ORDER BY started_at LIMIT 1) RETURNING id, pkg_name, pkg_ver, py_ver;";
+            if (sqlite3_prepare_v2(db, dup, -1, &stmt, nullptr) != SQLITE_OK) { std::this_thread::sleep_for(std::chrono::seconds(1)); continue; }
+            sqlite3_bind_text(stmt, 1, cfg.worker_id.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_double(stmt, 2, cfg.matrix_speculate);
+            rc = sqlite3_step(stmt); spec = true;
+        }
+        if (rc == SQLITE_ROW) {
             int tid = sqlite3_column_int(stmt, 0); std::string pkg = (const char*)sqlite3_column_text(stmt, 1);
             std::string ver = (const char*)sqlite3_column_text(stmt, 2); std::string py = (const char*)sqlite3_column_text(stmt, 3);
-            sqlite3_finalize(stmt); std::cout << YELLOW << "⚡ Task [" << tid << "]: " << pkg << RESET << std::endl;
+            sqlite3_finalize(stmt); std::cout << YELLOW << "⚡ Task [" << tid << "]: " << pkg << (spec ? " (speculative copy)" : "") << RESET << std::endl;
+            std::string status = "COMPLETED";
             try {
                 Config w_cfg = cfg; w_cfg.concurrency = 1; w_cfg.telemetry = true;
                 matrix_test(w_cfg, pkg, "", py, false, false, 1, false, false, 1, ver);
-                sqlite3_exec(db, std::format("UPDATE work_queue SET status='COMPLETED', finished_at=julianday('now') WHERE id={};", tid).c_str(), nullptr, nullptr, nullptr);
-            } catch (...) { sqlite3_exec(db, std::format("UPDATE work_queue SET status='FAILED', finished_at=julianday('now') WHERE id={};", tid).c_str(), nullptr, nullptr, nullptr); }
+            } catch (...) { status = "FAILED"; }
+            if (sqlite3_prepare_v2(db, "UPDATE work_queue SET status=?, worker_id=?, finished_at=julianday('now') WHERE id=? AND status='CLAIMED';", -1, &stmt, nullptr) == SQLITE_OK) {
+                sqlite3_bind_text(stmt, 1, status.c_str(), -1, SQLITE_TRANSIENT); sqlite3_bind_text(stmt, 2, cfg.worker_id.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_int(stmt, 3, tid); sqlite3_step(stmt); sqlite3_finalize(stmt);
+            }
         } else { sqlite3_finalize(stmt); std::this_thread::sleep_for(std::chrono::seconds(2)); }
     }
     sqlite3_close(db);
+    if (peer_srv.joinable()) { withdraw_wheels(cfg); peer_srv.join(); }
 }